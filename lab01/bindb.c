@@ -0,0 +1,210 @@
+//
+//  bindb.c
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bindb.h"
+
+/**
+ * Checks that every column of a freshly mapped database is usable:
+ * ids strictly increasing, name offsets inside the heap, heap
+ * NUL-terminated
+ *
+ * @param b             the database
+ * @param heap_size     size of the string heap
+ * @return 0 if valid, -1 if corrupt
+ */
+int bindb_validate(const bindb_t *b, uint32_t heap_size) {
+    if (b->count && (heap_size == 0 || b->heap[heap_size - 1] != '\0')) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < b->count; i++) {
+        if (i > 0 && b->ids[i - 1] >= b->ids[i]) return -1;
+        if (b->first_names[i] >= heap_size || b->last_names[i] >= heap_size) return -1;
+    }
+    return 0;
+}
+
+/**
+ * Maps a binary database
+ *
+ * @param b             the database to fill
+ * @param filename      the filename string
+ * @return 0 on success, 1 if the file is not a binary database,
+ *         -1 if it cannot be read or is corrupt
+ */
+int bindb_open(bindb_t *b, const char *filename) {
+    bindb_header_t header;
+    struct stat st;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+
+    if (read(fd, &header, sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, BINDB_MAGIC, sizeof(header.magic)) != 0) {
+        close(fd);
+        return 1;
+    }
+
+    if (header.version != BINDB_VERSION || fstat(fd, &st) == -1 ||
+        (size_t)st.st_size != sizeof(header) + 4*sizeof(uint32_t)*(size_t)header.count + header.heap_size) {
+        fprintf(stderr, "Unsupported or truncated binary database: %s\n", filename);
+        close(fd);
+        return -1;
+    }
+
+    b->map_size = st.st_size;
+    b->map = mmap(NULL, b->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (b->map == MAP_FAILED) {
+        return -1;
+    }
+
+    const uint32_t *columns = (const uint32_t *)((const char *)b->map + sizeof(header));
+    b->count = header.count;
+    b->ids = columns;
+    b->salaries = columns + header.count;
+    b->first_names = columns + 2*(size_t)header.count;
+    b->last_names = columns + 3*(size_t)header.count;
+    b->heap = (const char *)(columns + 4*(size_t)header.count);
+
+    if (bindb_validate(b, header.heap_size)) {
+        fprintf(stderr, "Corrupt binary database: %s\n", filename);
+        bindb_close(b);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Unmaps a binary database
+ *
+ * @param b             the database
+ */
+void bindb_close(bindb_t *b) {
+    munmap(b->map, b->map_size);
+    b->map = NULL;
+}
+
+/**
+ * Finds the record with the given id
+ *
+ * @param b             the database
+ * @param id            employee's id
+ * @return the record number, -1 if not found
+ */
+int bindb_find_by_id(const bindb_t *b, unsigned int id) {
+    uint32_t lo = 0, hi = b->count;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo)/2;
+        if (b->ids[mid] < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < b->count && b->ids[lo] == id) ? (int)lo : -1;
+}
+
+/**
+ * Fills e with record i. The names point into the mapping.
+ *
+ * @param b             the database
+ * @param i             the record number
+ * @param e             the employee to fill
+ */
+void bindb_get(const bindb_t *b, int i, employee_t *e) {
+    e->id = b->ids[i];
+    e->salary = b->salaries[i];
+    e->first_name = (char *)b->heap + b->first_names[i];
+    e->last_name = (char *)b->heap + b->last_names[i];
+    e->mapped = MAPPED_FIRST_NAME | MAPPED_LAST_NAME;
+}
+
+/**
+ * Writes one column of a binary database
+ *
+ * @param f             the file
+ * @param db            the database
+ * @param db_size       the database size
+ * @param column        0 ids, 1 salaries, 2 first name offsets, 3 last name offsets
+ * @return 0 on success, -1 on failure
+ */
+int write_column(FILE *f, employee_t **db, size_t db_size, int column) {
+    uint32_t offset = 0;
+
+    for (size_t i = 0; i < db_size; i++) {
+        uint32_t first = offset;
+        uint32_t last = first + (uint32_t)strlen(db[i]->first_name) + 1;
+        uint32_t vals[4] = { db[i]->id, db[i]->salary, first, last };
+
+        offset = last + (uint32_t)strlen(db[i]->last_name) + 1;
+        if (fwrite(&vals[column], sizeof(uint32_t), 1, f) != 1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Writes a database in binary format
+ *
+ * @param filename      the filename string
+ * @param db            the database, sorted by id
+ * @param db_size       the database size
+ * @return 0 on success, -1 on failure
+ */
+int bindb_write(const char *filename, employee_t **db, size_t db_size) {
+    bindb_header_t header;
+    size_t heap_size = 0;
+
+    for (size_t i = 0; i < db_size; i++) {
+        heap_size += strlen(db[i]->first_name) + strlen(db[i]->last_name) + 2;
+    }
+    if (db_size > UINT32_MAX || heap_size > UINT32_MAX) {
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINDB_MAGIC, sizeof(header.magic));
+    header.version = BINDB_VERSION;
+    header.count = (uint32_t)db_size;
+    header.heap_size = (uint32_t)heap_size;
+
+    FILE *f = fopen(filename, "wb");
+    if (!f) {
+        return -1;
+    }
+
+    int ret = fwrite(&header, sizeof(header), 1, f) == 1 ? 0 : -1;
+    for (int column = 0; column < 4 && ret == 0; column++) {
+        ret = write_column(f, db, db_size, column);
+    }
+    for (size_t i = 0; i < db_size && ret == 0; i++) {
+        if (fwrite(db[i]->first_name, strlen(db[i]->first_name) + 1, 1, f) != 1 ||
+            fwrite(db[i]->last_name, strlen(db[i]->last_name) + 1, 1, f) != 1) {
+            ret = -1;
+        }
+    }
+
+    if (fclose(f) != 0) {
+        ret = -1;
+    }
+    return ret;
+}
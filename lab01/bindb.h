@@ -0,0 +1,97 @@
+//
+//  bindb.h
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#ifndef employee_db_bindb_h
+#define employee_db_bindb_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "core.h"
+
+/*
+ * Binary database format, written in host byte order:
+ *
+ *   header       bindb_header_t
+ *   ids          uint32_t[count], sorted ascending (the id index)
+ *   salaries     uint32_t[count]
+ *   first_names  uint32_t[count], offsets into the string heap
+ *   last_names   uint32_t[count], offsets into the string heap
+ *   heap         heap_size bytes of NUL-terminated strings
+ *
+ * Every column is indexed by the same record number. The file is
+ * mapped read-only and queried in place.
+ */
+
+#define BINDB_MAGIC     "EMPDBBIN"
+#define BINDB_VERSION   1
+
+typedef struct bindb_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t heap_size;
+    uint32_t reserved;
+} bindb_header_t;
+
+typedef struct bindb {
+    void *map;
+    size_t map_size;
+    uint32_t count;
+    const uint32_t *ids;
+    const uint32_t *salaries;
+    const uint32_t *first_names;
+    const uint32_t *last_names;
+    const char *heap;
+} bindb_t;
+
+/**
+ * Maps a binary database
+ *
+ * @param b             the database to fill
+ * @param filename      the filename string
+ * @return 0 on success, 1 if the file is not a binary database,
+ *         -1 if it cannot be read or is corrupt
+ */
+int bindb_open(bindb_t *b, const char *filename);
+
+/**
+ * Unmaps a binary database
+ *
+ * @param b             the database
+ */
+void bindb_close(bindb_t *b);
+
+/**
+ * Finds the record with the given id
+ *
+ * @param b             the database
+ * @param id            employee's id
+ * @return the record number, -1 if not found
+ */
+int bindb_find_by_id(const bindb_t *b, unsigned int id);
+
+/**
+ * Fills e with record i. The names point into the mapping.
+ *
+ * @param b             the database
+ * @param i             the record number
+ * @param e             the employee to fill
+ */
+void bindb_get(const bindb_t *b, int i, employee_t *e);
+
+/**
+ * Writes a database in binary format
+ *
+ * @param filename      the filename string
+ * @param db            the database, sorted by id
+ * @param db_size       the database size
+ * @return 0 on success, -1 on failure
+ */
+int bindb_write(const char *filename, employee_t **db, size_t db_size);
+
+#endif
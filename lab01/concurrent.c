@@ -0,0 +1,350 @@
+//
+//  concurrent.c
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "concurrent.h"
+
+/*** Helper functions ***/
+
+/**
+ * Allocates a snapshot with room for capacity records
+ *
+ * @param capacity      number of records
+ * @return the new snapshot
+ */
+snapshot_t *new_snapshot(size_t capacity) {
+    snapshot_t *s = malloc(sizeof(snapshot_t));
+    s->records = malloc(sizeof(employee_t*)*(capacity ? capacity : 1));
+    s->size = 0;
+    return s;
+}
+
+/**
+ * Frees a snapshot, but not the employees it points to
+ *
+ * @param s             the snapshot
+ */
+void free_snapshot(snapshot_t *s) {
+    free(s->records);
+    free(s);
+}
+
+/**
+ * Frees an employee and the names it owns
+ *
+ * @param e             the employee
+ */
+void free_employee(employee_t *e) {
+    if (!(e->mapped & MAPPED_FIRST_NAME)) free(e->first_name);
+    if (!(e->mapped & MAPPED_LAST_NAME)) free(e->last_name);
+    if (!(e->mapped & MAPPED_RECORD)) free(e);
+}
+
+/**
+ * Finds the index of id in a snapshot, or where it would be inserted
+ *
+ * @param s             the snapshot
+ * @param id            employee's id
+ * @return the lower bound index
+ */
+size_t lower_bound(const snapshot_t *s, unsigned int id) {
+    size_t lo = 0, hi = s->size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo)/2;
+        if (s->records[mid]->id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Frees every retired snapshot that no reader can still hold. A
+ * retired snapshot tagged with epoch E was unpublished before the
+ * global epoch reached E, so any reader that announced an epoch >= E
+ * loaded a later snapshot. Must hold write_lock.
+ *
+ * @param cdb           the concurrent db
+ */
+void reclaim(cdb_t *cdb) {
+    unsigned long oldest = __atomic_load_n(&cdb->epoch, __ATOMIC_SEQ_CST);
+    retired_t **link = &cdb->retired;
+
+    for (int i = 0; i < CDB_MAX_READERS; i++) {
+        unsigned long e = __atomic_load_n(&cdb->readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (e && e < oldest) {
+            oldest = e;
+        }
+    }
+
+    while (*link) {
+        retired_t *r = *link;
+        if (r->epoch <= oldest) {
+            *link = r->next;
+            free_snapshot(r->snap);
+            if (r->replaced && !(r->replaced->mapped & MAPPED_RECORD)) {
+                free(r->replaced);
+            }
+            if (r->removed) {
+                free_employee(r->removed);
+            }
+            free(r);
+        } else {
+            link = &r->next;
+        }
+    }
+}
+
+/**
+ * Publishes a new snapshot and retires the old one. Must hold
+ * write_lock.
+ *
+ * @param cdb           the concurrent db
+ * @param s             the new snapshot
+ * @param replaced      employee replaced by a copy, or NULL
+ * @param removed       employee removed from the db, or NULL
+ */
+void publish(cdb_t *cdb, snapshot_t *s, employee_t *replaced, employee_t *removed) {
+    retired_t *r = malloc(sizeof(retired_t));
+
+    r->snap = __atomic_exchange_n(&cdb->current, s, __ATOMIC_SEQ_CST);
+    r->replaced = replaced;
+    r->removed = removed;
+    r->epoch = __atomic_add_fetch(&cdb->epoch, 1, __ATOMIC_SEQ_CST);
+    r->next = cdb->retired;
+    cdb->retired = r;
+
+    reclaim(cdb);
+}
+
+/*** Lifecycle ***/
+
+/**
+ * Creates a concurrent db, taking ownership of the employees in db
+ *
+ * @param db            the database (sorted by id)
+ * @param db_size       the database size
+ * @return the concurrent db
+ */
+cdb_t *cdb_open(employee_t **db, size_t db_size) {
+    cdb_t *cdb = calloc(1, sizeof(cdb_t));
+    snapshot_t *s = new_snapshot(db_size);
+
+    memcpy(s->records, db, sizeof(employee_t*)*db_size);
+    s->size = db_size;
+
+    cdb->current = s;
+    cdb->epoch = 1;
+    pthread_mutex_init(&cdb->write_lock, NULL);
+
+    return cdb;
+}
+
+/**
+ * Frees the concurrent db and every employee in it. No readers or
+ * writers may be active.
+ *
+ * @param cdb           the concurrent db
+ */
+void cdb_close(cdb_t *cdb) {
+    snapshot_t *s = cdb->current;
+
+    // no readers left, so everything retired can go
+    __atomic_add_fetch(&cdb->epoch, 1, __ATOMIC_SEQ_CST);
+    reclaim(cdb);
+
+    for (size_t i = 0; i < s->size; i++) {
+        free_employee(s->records[i]);
+    }
+    free_snapshot(s);
+
+    pthread_mutex_destroy(&cdb->write_lock);
+    free(cdb);
+}
+
+/*** Readers ***/
+
+/**
+ * Enters a read-side critical section
+ *
+ * @param cdb           the concurrent db
+ * @param slot          the reader's slot, 0 <= slot < CDB_MAX_READERS
+ * @return the snapshot to read from, valid until cdb_reader_exit
+ */
+const snapshot_t *cdb_reader_enter(cdb_t *cdb, int slot) {
+    unsigned long e = __atomic_load_n(&cdb->epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&cdb->readers[slot].epoch, e, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&cdb->current, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Leaves a read-side critical section
+ *
+ * @param cdb           the concurrent db
+ * @param slot          the reader's slot
+ */
+void cdb_reader_exit(cdb_t *cdb, int slot) {
+    __atomic_store_n(&cdb->readers[slot].epoch, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Finds the employee with the given id in a snapshot
+ *
+ * @param s             the snapshot
+ * @param id            employee's id
+ * @return the employee, NULL if not found
+ */
+const employee_t *snapshot_find_by_id(const snapshot_t *s, unsigned int id) {
+    int idx = find_by_id(s->records, s->size, id);
+    return idx == -1 ? NULL : s->records[idx];
+}
+
+/**
+ * Finds the first employee with the given last name in a snapshot
+ *
+ * @param s             the snapshot
+ * @param last_name     the last_name of the employee
+ * @return the employee, NULL if not found
+ */
+const employee_t *snapshot_find_by_last_name(const snapshot_t *s, const char *last_name) {
+    for (size_t i = 0; i < s->size; i++) {
+        if (strcmp(s->records[i]->last_name, last_name) == 0) {
+            return s->records[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Finds the num highest salaries in a snapshot
+ *
+ * @param s             the snapshot
+ * @param num           the number of salaries
+ * @param highest       array of at least num employees to fill
+ * @return the number of employees written to highest
+ */
+size_t snapshot_highest_salaries(const snapshot_t *s, size_t num, const employee_t **highest) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < s->size; i++) {
+        const employee_t *e = s->records[i];
+        size_t idx = count;
+
+        // find insertion point, keeping highest sorted descending
+        while (idx > 0 && e->salary > highest[idx - 1]->salary) {
+            idx--;
+        }
+        if (idx == num) continue;
+
+        if (count < num) count++;
+        for (size_t j = count - 1; j > idx; j--) {
+            highest[j] = highest[j - 1];
+        }
+        highest[idx] = e;
+    }
+
+    return count;
+}
+
+/*** Writers ***/
+
+/**
+ * Inserts an employee
+ *
+ * @param cdb           the concurrent db
+ * @param e             the new employee, owned by the db on success
+ * @return 0 on success, -1 if the id exists or the db is full
+ */
+int cdb_insert(cdb_t *cdb, employee_t *e) {
+    pthread_mutex_lock(&cdb->write_lock);
+
+    snapshot_t *old = cdb->current;
+    size_t idx = lower_bound(old, e->id);
+    if (old->size >= MAXDBSIZE || (idx < old->size && old->records[idx]->id == e->id)) {
+        pthread_mutex_unlock(&cdb->write_lock);
+        return -1;
+    }
+
+    snapshot_t *s = new_snapshot(old->size + 1);
+    memcpy(s->records, old->records, sizeof(employee_t*)*idx);
+    s->records[idx] = e;
+    memcpy(s->records + idx + 1, old->records + idx, sizeof(employee_t*)*(old->size - idx));
+    s->size = old->size + 1;
+
+    publish(cdb, s, NULL, NULL);
+
+    pthread_mutex_unlock(&cdb->write_lock);
+    return 0;
+}
+
+/**
+ * Removes the employee with the given id
+ *
+ * @param cdb           the concurrent db
+ * @param id            employee's id
+ * @return 0 on success, -1 if not found
+ */
+int cdb_remove(cdb_t *cdb, unsigned int id) {
+    pthread_mutex_lock(&cdb->write_lock);
+
+    snapshot_t *old = cdb->current;
+    size_t idx = lower_bound(old, id);
+    if (idx == old->size || old->records[idx]->id != id) {
+        pthread_mutex_unlock(&cdb->write_lock);
+        return -1;
+    }
+
+    snapshot_t *s = new_snapshot(old->size - 1);
+    memcpy(s->records, old->records, sizeof(employee_t*)*idx);
+    memcpy(s->records + idx, old->records + idx + 1, sizeof(employee_t*)*(old->size - idx - 1));
+    s->size = old->size - 1;
+
+    publish(cdb, s, NULL, old->records[idx]);
+
+    pthread_mutex_unlock(&cdb->write_lock);
+    return 0;
+}
+
+/**
+ * Updates the salary of the employee with the given id
+ *
+ * @param cdb           the concurrent db
+ * @param id            employee's id
+ * @param salary        the new salary
+ * @return 0 on success, -1 if not found
+ */
+int cdb_update_salary(cdb_t *cdb, unsigned int id, unsigned int salary) {
+    pthread_mutex_lock(&cdb->write_lock);
+
+    snapshot_t *old = cdb->current;
+    size_t idx = lower_bound(old, id);
+    if (idx == old->size || old->records[idx]->id != id) {
+        pthread_mutex_unlock(&cdb->write_lock);
+        return -1;
+    }
+
+    // copy on write: readers of the old snapshot keep the old record
+    employee_t *prev = old->records[idx];
+    employee_t *e = new_employee(prev->id, prev->first_name, prev->last_name, salary);
+    e->mapped = prev->mapped & ~MAPPED_RECORD;
+
+    snapshot_t *s = new_snapshot(old->size);
+    memcpy(s->records, old->records, sizeof(employee_t*)*old->size);
+    s->records[idx] = e;
+    s->size = old->size;
+
+    publish(cdb, s, prev, NULL);
+
+    pthread_mutex_unlock(&cdb->write_lock);
+    return 0;
+}
@@ -0,0 +1,146 @@
+//
+//  concurrent.h
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#ifndef employee_db_concurrent_h
+#define employee_db_concurrent_h
+
+#include <stddef.h>
+#include <pthread.h>
+#include "core.h"
+
+#define CDB_MAX_READERS 64
+
+/*
+ * A concurrent, read-mostly view of the database.
+ *
+ * Readers never block: they announce the epoch they are reading in,
+ * load the current snapshot and query it directly. A snapshot (and
+ * every employee it points to) is immutable once published.
+ *
+ * Writers are serialized by a mutex. Every write copies the pointer
+ * array, publishes the copy, and retires the old snapshot. Retired
+ * snapshots are freed once no reader can still be holding them.
+ */
+
+typedef struct snapshot {
+    employee_t **records;   // sorted by id
+    size_t size;
+} snapshot_t;
+
+typedef struct retired {
+    snapshot_t *snap;
+    employee_t *replaced;   // shares its names with its replacement
+    employee_t *removed;    // owns its names
+    unsigned long epoch;
+    struct retired *next;
+} retired_t;
+
+typedef struct reader_slot {
+    unsigned long epoch;    // 0 when the reader is quiescent
+    char pad[64 - sizeof(unsigned long)];
+} reader_slot_t;
+
+typedef struct cdb {
+    snapshot_t *current;
+    unsigned long epoch;
+    reader_slot_t readers[CDB_MAX_READERS];
+    pthread_mutex_t write_lock;
+    retired_t *retired;
+} cdb_t;
+
+/**
+ * Creates a concurrent db, taking ownership of the employees in db
+ *
+ * @param db            the database (sorted by id)
+ * @param db_size       the database size
+ * @return the concurrent db
+ */
+cdb_t *cdb_open(employee_t **db, size_t db_size);
+
+/**
+ * Frees the concurrent db and every employee in it. No readers or
+ * writers may be active.
+ *
+ * @param cdb           the concurrent db
+ */
+void cdb_close(cdb_t *cdb);
+
+/**
+ * Enters a read-side critical section
+ *
+ * @param cdb           the concurrent db
+ * @param slot          the reader's slot, 0 <= slot < CDB_MAX_READERS
+ * @return the snapshot to read from, valid until cdb_reader_exit
+ */
+const snapshot_t *cdb_reader_enter(cdb_t *cdb, int slot);
+
+/**
+ * Leaves a read-side critical section
+ *
+ * @param cdb           the concurrent db
+ * @param slot          the reader's slot
+ */
+void cdb_reader_exit(cdb_t *cdb, int slot);
+
+/**
+ * Finds the employee with the given id in a snapshot
+ *
+ * @param s             the snapshot
+ * @param id            employee's id
+ * @return the employee, NULL if not found
+ */
+const employee_t *snapshot_find_by_id(const snapshot_t *s, unsigned int id);
+
+/**
+ * Finds the first employee with the given last name in a snapshot
+ *
+ * @param s             the snapshot
+ * @param last_name     the last_name of the employee
+ * @return the employee, NULL if not found
+ */
+const employee_t *snapshot_find_by_last_name(const snapshot_t *s, const char *last_name);
+
+/**
+ * Finds the num highest salaries in a snapshot
+ *
+ * @param s             the snapshot
+ * @param num           the number of salaries
+ * @param highest       array of at least num employees to fill
+ * @return the number of employees written to highest
+ */
+size_t snapshot_highest_salaries(const snapshot_t *s, size_t num, const employee_t **highest);
+
+/**
+ * Inserts an employee
+ *
+ * @param cdb           the concurrent db
+ * @param e             the new employee, owned by the db on success
+ * @return 0 on success, -1 if the id exists or the db is full
+ */
+int cdb_insert(cdb_t *cdb, employee_t *e);
+
+/**
+ * Removes the employee with the given id
+ *
+ * @param cdb           the concurrent db
+ * @param id            employee's id
+ * @return 0 on success, -1 if not found
+ */
+int cdb_remove(cdb_t *cdb, unsigned int id);
+
+/**
+ * Updates the salary of the employee with the given id
+ *
+ * @param cdb           the concurrent db
+ * @param id            employee's id
+ * @param salary        the new salary
+ * @return 0 on success, -1 if not found
+ */
+int cdb_update_salary(cdb_t *cdb, unsigned int id, unsigned int salary);
+
+#endif
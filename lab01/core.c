@@ -12,6 +12,12 @@
 #include "core.h"
 #include "readfile.h"
 #include "sort.h"
+#include "salary_index.h"
+#include "name_index.h"
+#include "bindb.h"
+
+/* The most records db has room for */
+static size_t db_capacity = MAXDBSIZE;
 
 #define PRINT_EMPLOYEE_HEADER() printf("%-8s%-15s%-15s%-10s\n", "ID", "First Name", "Last Name", "Salary"); \
     printf("---------------------------------------------\n")
@@ -48,6 +54,7 @@ employee_t *new_employee(unsigned int id, char *first_name, char *last_name, uns
     e->first_name = first_name;
     e->last_name = last_name;
     e->salary = salary;
+    e->mapped = 0;
     return e;
 }
 
@@ -65,6 +72,25 @@ void print_employee(employee_t *e, unsigned int header) {
     printf("%-8u%-15s%-15s$%6u\n", e->id, e->first_name, e->last_name, e->salary);
 }
 
+/**
+ * Prints an employee without a header, for index traversals
+ *
+ * @param e         employee_t pointer
+ */
+void print_salary_employee(employee_t *e) {
+    print_employee(e, 0);
+}
+
+/**
+ * Prints an employee and its edit distance, for fuzzy searches
+ *
+ * @param e         employee_t pointer
+ * @param dist      edit distance from the query
+ */
+void print_fuzzy_employee(employee_t *e, int dist) {
+    printf("%-8u%-15s%-15s$%6u  (%d)\n", e->id, e->first_name, e->last_name, e->salary, dist);
+}
+
 /**
  * Prints the db
  *
@@ -196,43 +222,88 @@ void find_all_by_last_name(employee_t **db, size_t db_size, char *last_name) {
     }
 }
 
+/**
+ * Finds all employees whose last name starts with prefix
+ *
+ * @param last_names    the last name index
+ * @param prefix        the prefix
+ */
+void find_by_last_name_prefix(name_index_t *last_names, char *prefix) {
+    PRINT_EMPLOYEE_HEADER();
+    size_t count = name_index_prefix(last_names, prefix, print_salary_employee);
+    printf("(%lu records)\n\n", count);
+}
+
+/**
+ * Finds all employees whose last name is within max_dist edits of
+ * last_name
+ *
+ * @param last_names    the last name index
+ * @param last_name     the last_name to match
+ * @param max_dist      the largest edit distance to accept
+ */
+void find_by_last_name_fuzzy(name_index_t *last_names, char *last_name, int max_dist) {
+    PRINT_EMPLOYEE_HEADER();
+    size_t count = name_index_fuzzy(last_names, last_name, max_dist, print_fuzzy_employee);
+    printf("(%lu records within %d edits)\n\n", count, max_dist);
+}
+
 /**
  * Finds the num highest salaries
  *
- * @param db            the database
- * @param db_size       the database size
+ * @param salaries      the salary index
  * @param num   the number of salaries
  */
-void find_highest_salaries(employee_t **db, size_t db_size, unsigned long num) {
-    employee_t **highest = calloc(num, sizeof(employee_t));
+void find_highest_salaries(salary_index_t *salaries, unsigned long num) {
+    size_t size = salary_index_size(salaries);
     
-    for (int i = 0; i < db_size; i++) {
-        int idx;
-        // find insertion point
-        for (idx = 0; idx < num; idx++) {
-            if (!highest[idx] || db[i]->salary > highest[idx]->salary) {
-                break;
-            }
-        }
-        
-        // shift all elements above
-        for (int j = (int)num - 1; j >= idx; j--) {
-            highest[j+1] = highest[j];
-            highest[j] = NULL;
-        }
-        
-        highest[idx] = db[i];
+    PRINT_EMPLOYEE_HEADER();
+    for (size_t i = 0; i < num && i < size; i++) {
+        print_employee(salary_index_kth(salaries, size - 1 - i), 0);
     }
     
+    printf("\n");
+}
+
+/**
+ * Prints employees with salaries in [min, max] with their count and sum
+ *
+ * @param salaries      the salary index
+ * @param min           lowest salary
+ * @param max           highest salary
+ */
+void find_salary_range(salary_index_t *salaries, unsigned int min, unsigned int max) {
+    size_t count = salary_index_count_range(salaries, min, max);
+    unsigned long long total = salary_index_sum_range(salaries, min, max);
+    
     PRINT_EMPLOYEE_HEADER();
-    for (int i = 0; i < num; i++) {
-        print_employee(highest[i], 0);
+    salary_index_range(salaries, min, max, print_salary_employee);
+    
+    printf("(%lu records, total $%llu", count, total);
+    if (count) {
+        printf(", average $%.2f", total/(double)count);
     }
+    printf(")\n\n");
+}
+
+/**
+ * Prints the median salary and the employee at the given percentile
+ *
+ * @param salaries      the salary index
+ * @param p             percentile, 0 < p <= 100
+ */
+void print_salary_percentile(salary_index_t *salaries, double p) {
+    employee_t *e = salary_index_percentile(salaries, p);
     
-    printf("\n");
+    if (!e) {
+        printf("The database is empty\n\n");
+        return;
+    }
     
-    free(highest);
-    highest = NULL;
+    printf("Median salary: $%.2f\n", salary_index_median(salaries));
+    printf("%gth percentile salary: $%u\n", p, e->salary);
+    print_employee(e, 1);
+    printf("\n");
 }
 
 /**
@@ -240,11 +311,13 @@ void find_highest_salaries(employee_t **db, size_t db_size, unsigned long num) {
  *
  * @param db            the database
  * @param db_size       the database size
+ * @param salaries      the salary index
+ * @param last_names    the last name index
  * @param e     the new employee
  * @return the index of the employee
  */
-int insert_employee(employee_t ***db, size_t *db_size, employee_t *e) {
-    if (*db_size < MAXDBSIZE) {
+int insert_employee(employee_t ***db, size_t *db_size, salary_index_t *salaries, name_index_t *last_names, employee_t *e) {
+    if (*db_size < db_capacity) {
         int i;
         // find insertion point
         for (i = 0; i < *db_size; i++) {
@@ -260,6 +333,8 @@ int insert_employee(employee_t ***db, size_t *db_size, employee_t *e) {
         
         (*db)[i] = e;
         (*db_size)++;
+        salary_index_insert(salaries, e);
+        name_index_insert(last_names, e->last_name, e);
         
         return i;
     } else {
@@ -272,10 +347,16 @@ int insert_employee(employee_t ***db, size_t *db_size, employee_t *e) {
  * 
  * @param db            the database
  * @param db_size       the database size
+ * @param salaries      the salary index
+ * @param last_names    the last name index
  * @param idx   index of the employee
  */
-void remove_employee(employee_t ***db, size_t *db_size, int idx) {
-    free((*db)[idx]);
+void remove_employee(employee_t ***db, size_t *db_size, salary_index_t *salaries, name_index_t *last_names, int idx) {
+    salary_index_remove(salaries, (*db)[idx]);
+    name_index_remove(last_names, (*db)[idx]->last_name, (*db)[idx]);
+    if (!((*db)[idx]->mapped & MAPPED_RECORD)) {
+        free((*db)[idx]);
+    }
     (*db)[idx] = NULL;
     
     for (int i = idx; i < (*db_size - 1); i++) {
@@ -342,7 +423,56 @@ int read_line(int *id, char **first_name, char **last_name, unsigned int *salary
 }
 
 /**
- * Reads the database from the given filename
+ * Loads a binary database. The records are read from the mapping once,
+ * already sorted, into one block, with names pointing into the mapping,
+ * which stays alive for the rest of the program; db has room for
+ * MAXDBSIZE more.
+ *
+ * @param db            the database
+ * @param db_size       the database size
+ * @param b             the mapped binary database
+ * @return 0 if success -1 if fail
+ */
+int load_bindb(employee_t ***db, size_t *db_size, bindb_t *b) {
+    employee_t *records = malloc(sizeof(employee_t)*(b->count ? b->count : 1));
+    
+    db_capacity = b->count + MAXDBSIZE;
+    *db = malloc(sizeof(employee_t*)*(db_capacity + 1));
+    if (!records || !*db) {
+        free(records);
+        free(*db);
+        fprintf(stderr, "Out of memory loading %u records\n", b->count);
+        return -1;
+    }
+    
+    for (uint32_t i = 0; i < b->count; i++) {
+        bindb_get(b, (int)i, &records[i]);
+        records[i].mapped |= MAPPED_RECORD;
+        (*db)[i] = &records[i];
+    }
+    
+    *db_size = b->count;
+    return 0;
+}
+
+/**
+ * Frees an employee's name unless it points into a mapped database
+ *
+ * @param e         the employee
+ * @param name      the first_name or last_name field
+ * @param mapped    the MAPPED_* bit for that field
+ */
+void free_name(employee_t *e, char **name, unsigned int mapped) {
+    if (!(e->mapped & mapped)) {
+        free(*name);
+    }
+    e->mapped &= ~mapped;
+    *name = NULL;
+}
+
+/**
+ * Reads the database from the given filename. Binary databases (see
+ * bindb.h) are mapped instead of parsed.
  *
  * @param db            the database
  * @param db_size       the database size
@@ -350,6 +480,16 @@ int read_line(int *id, char **first_name, char **last_name, unsigned int *salary
  * @return 0
  */
 int read_database(employee_t ***db, size_t *db_size, char filename[]) {
+    bindb_t b;
+    int bin_result = bindb_open(&b, filename);
+    if (bin_result != 1) {
+        if (bin_result == 0) {
+            return load_bindb(db, db_size, &b);
+        }
+        fprintf(stderr, "Could not read file: %s\n", filename);
+        return bin_result;
+    }
+    
     int file_result = openFile(filename);
     if (file_result) {
         fprintf(stderr, "Could not read file: %s\n", filename);
@@ -389,9 +529,11 @@ int read_database(employee_t ***db, size_t *db_size, char filename[]) {
  *
  * @param db            the database
  * @param db_size       the database size
+ * @param salaries      the salary index over the database
+ * @param last_names    the last name index over the database
  * @return 0 if success -1 if fail
  */
-int run_loop(employee_t ***db, size_t *db_size) {
+int run_loop(employee_t ***db, size_t *db_size, salary_index_t *salaries, name_index_t *last_names) {
     state_t current_state = START;
     char *line = NULL;
     char *endptr;
@@ -401,6 +543,9 @@ int run_loop(employee_t ***db, size_t *db_size) {
     unsigned long id = 0;
     unsigned long salary = 0;
     unsigned long num = 0;
+    unsigned long min_salary = 0;
+    double percentile = 0;
+    unsigned long max_dist = 0;
     int idx = -1;
     employee_t *new_e = NULL;
     
@@ -416,6 +561,10 @@ int run_loop(employee_t ***db, size_t *db_size) {
                 printf("7. Update an employee\n");
                 printf("8. Print employees with highest salaries\n");
                 printf("9. Find all with last name\n");
+                printf("10. Find employees by salary range\n");
+                printf("11. Salary median and percentiles\n");
+                printf("12. Find by last name prefix\n");
+                printf("13. Find by similar last name\n");
 				printf(">>> ");
 				break;
             case LOOKUP_BY_ID:
@@ -479,6 +628,18 @@ int run_loop(employee_t ***db, size_t *db_size) {
             case FIND_ALL_LASTNAME:
                 printf("Enter last name >>> ");
                 break;
+            case SALARY_RANGE:
+                printf("Enter salary range (min max) >>> ");
+                break;
+            case SALARY_PERCENTILE:
+                printf("Enter percentile (0 to 100) >>> ");
+                break;
+            case LASTNAME_PREFIX:
+                printf("Enter last name prefix >>> ");
+                break;
+            case LASTNAME_FUZZY:
+                printf("Enter last name [max edits, default %d] >>> ", MAXFUZZY);
+                break;
                 
 		}
         
@@ -530,6 +691,22 @@ int run_loop(employee_t ***db, size_t *db_size) {
                                     current_state = FIND_ALL_LASTNAME;
                                     continue;
                                     break;
+                                case 10:
+                                    current_state = SALARY_RANGE;
+                                    continue;
+                                    break;
+                                case 11:
+                                    current_state = SALARY_PERCENTILE;
+                                    continue;
+                                    break;
+                                case 12:
+                                    current_state = LASTNAME_PREFIX;
+                                    continue;
+                                    break;
+                                case 13:
+                                    current_state = LASTNAME_FUZZY;
+                                    continue;
+                                    break;
                             }
                         }
                         break;
@@ -627,11 +804,11 @@ int run_loop(employee_t ***db, size_t *db_size) {
                     // Add employee verify
                     case ADD_EMPLOYEE_VERIFY:
                         if (strcmp("Y", line) == 0 || strcmp("y", line) == 0) {
-                            int idx = insert_employee(db, db_size, new_e);
+                            int idx = insert_employee(db, db_size, salaries, last_names, new_e);
                             if (idx > -1) {
                                 printf("Inserted at %i\n\n", idx);
                             } else {
-                                printf("Database is at it's size limit of 1024 records.\n\n");
+                                printf("Database is at it's size limit of %zu records.\n\n", db_capacity);
                                 free(new_e);
                                 new_e = NULL;
                             }
@@ -670,7 +847,7 @@ int run_loop(employee_t ***db, size_t *db_size) {
                     // Remove employee verify
                     case REMOVE_EMPLOYEE_VERIFY:
                         if (strcmp("Y", line) == 0 || strcmp("y", line) == 0) {
-                            remove_employee(db, db_size, idx);
+                            remove_employee(db, db_size, salaries, last_names, idx);
                             printf("Employee removed\n\n");
                             current_state = START;
                         } else if (strcmp("N", line) == 0 || strcmp("n", line) == 0) {
@@ -737,7 +914,9 @@ int run_loop(employee_t ***db, size_t *db_size) {
                         if (*endptr == '\0' && id >= 100000 && id <= 999999) {
                             int found = find_by_id(*db, *db_size, (unsigned int)id);
                             if (found == -1) {
+                                salary_index_remove(salaries, (*db)[idx]);
                                 (*db)[idx]->id = (unsigned int)id;
+                                salary_index_insert(salaries, (*db)[idx]);
                                 sort_db(db, *db_size);
                                 printf("Updated ID to %lu\n\n", id);
                                 current_state = UPDATE_EMPLOYEE_CHOOSE;
@@ -754,7 +933,7 @@ int run_loop(employee_t ***db, size_t *db_size) {
                     // Update employee's first name
                     case UPDATE_EMPLOYEE_FIRSTNAME:
                         if (*line != '\0' && is_valid_str(line, linelen)) {
-                            free((*db)[idx]->first_name);
+                            free_name((*db)[idx], &(*db)[idx]->first_name, MAPPED_FIRST_NAME);
                             (*db)[idx]->first_name = malloc(linelen*sizeof(char));
                             strcpy((*db)[idx]->first_name, line);
                             printf("Updated first name to %s\n", line);
@@ -769,9 +948,11 @@ int run_loop(employee_t ***db, size_t *db_size) {
                     // Update employee's last name
                     case UPDATE_EMPLOYEE_LASTNAME:
                         if (*line != '\0' && is_valid_str(line, linelen)) {
-                            free((*db)[idx]->last_name);
+                            name_index_remove(last_names, (*db)[idx]->last_name, (*db)[idx]);
+                            free_name((*db)[idx], &(*db)[idx]->last_name, MAPPED_LAST_NAME);
                             (*db)[idx]->last_name = malloc(linelen*sizeof(char));
                             strcpy((*db)[idx]->last_name, line);
+                            name_index_insert(last_names, (*db)[idx]->last_name, (*db)[idx]);
                             printf("Updated last name to %s\n", line);
                             current_state = UPDATE_EMPLOYEE_CHOOSE;
                         } else {
@@ -785,7 +966,9 @@ int run_loop(employee_t ***db, size_t *db_size) {
                     case UPDATE_EMPLOYEE_SALARY:
                         salary = strtoul(line, &endptr, 10);
                         if (*endptr == '\0' && salary >= 30000 && salary <= 150000) {
+                            salary_index_remove(salaries, (*db)[idx]);
                             (*db)[idx]->salary = (unsigned int)salary;
+                            salary_index_insert(salaries, (*db)[idx]);
                             printf("Updated salary to %lu\n", salary);
                             current_state = UPDATE_EMPLOYEE_CHOOSE;
                         } else {
@@ -799,7 +982,7 @@ int run_loop(employee_t ***db, size_t *db_size) {
                     case HIGHEST_SALARIES:
                         num = strtoul(line, &endptr, 10);
                         if (*endptr == '\0' && num > 0 && num <= *db_size) {
-                            find_highest_salaries(*db, *db_size, num);
+                            find_highest_salaries(salaries, num);
                             current_state = START;
                         } else {
                             printf("%s is not a valid number. Must be > 0 and <= %lu\n\n", line, *db_size);
@@ -815,6 +998,59 @@ int run_loop(employee_t ***db, size_t *db_size) {
                         current_state = START;
                         continue;
                         break;
+                        
+                    // Find employees by salary range
+                    case SALARY_RANGE:
+                        min_salary = strtoul(line, &endptr, 10);
+                        if (endptr != line && *endptr == ' ') {
+                            salary = strtoul(endptr, &endptr, 10);
+                            if (*endptr == '\0' && min_salary <= salary) {
+                                find_salary_range(salaries, (unsigned int)min_salary, (unsigned int)salary);
+                                current_state = START;
+                                continue;
+                            }
+                        }
+                        printf("%s is not a valid salary range. Enter two salaries, lowest first.\n\n", line);
+                        continue;
+                        break;
+                        
+                    // Salary median and percentiles
+                    case SALARY_PERCENTILE:
+                        percentile = strtod(line, &endptr);
+                        if (*endptr == '\0' && percentile > 0 && percentile <= 100) {
+                            print_salary_percentile(salaries, percentile);
+                            current_state = START;
+                        } else {
+                            printf("%s is not a valid percentile. Must be > 0 and <= 100\n\n", line);
+                        }
+                        
+                        continue;
+                        break;
+                        
+                    // Find by last name prefix
+                    case LASTNAME_PREFIX:
+                        find_by_last_name_prefix(last_names, line);
+                        current_state = START;
+                        continue;
+                        break;
+                        
+                    // Find by similar last name
+                    case LASTNAME_FUZZY:
+                        max_dist = MAXFUZZY;
+                        endptr = strchr(line, ' ');
+                        if (endptr) {
+                            *endptr++ = '\0';
+                            max_dist = strtoul(endptr, &endptr, 10);
+                        }
+                        if (!endptr || (*endptr == '\0' && max_dist <= MAXNAME)) {
+                            find_by_last_name_fuzzy(last_names, line, (int)max_dist);
+                            current_state = START;
+                        } else {
+                            printf("Please enter a last name, optionally followed by a number of edits.\n\n");
+                        }
+                        
+                        continue;
+                        break;
                 }
             }
         }
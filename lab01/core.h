@@ -12,6 +12,13 @@
 #define MAXFILENAME  128
 #define MAXNAME       64
 #define MAXDBSIZE   1024
+#define MAXFUZZY       2
+
+// employee_t.mapped bits: the name points into a mapped binary database,
+// or the record itself is part of the block load_bindb allocates
+#define MAPPED_FIRST_NAME   1
+#define MAPPED_LAST_NAME    2
+#define MAPPED_RECORD       4
 
 typedef enum {
 	START,
@@ -31,7 +38,11 @@ typedef enum {
     UPDATE_EMPLOYEE_LASTNAME,
     UPDATE_EMPLOYEE_SALARY,
     HIGHEST_SALARIES,
-    FIND_ALL_LASTNAME
+    FIND_ALL_LASTNAME,
+    SALARY_RANGE,
+    SALARY_PERCENTILE,
+    LASTNAME_PREFIX,
+    LASTNAME_FUZZY
 } state_t;
 
 typedef struct employee {
@@ -39,8 +50,12 @@ typedef struct employee {
     char *first_name;
     char *last_name;
     unsigned int salary;
+    unsigned int mapped;
 } employee_t;
 
+struct salary_index;
+struct name_index;
+
 /**
  * Gets the filename from the command line
  *
@@ -51,7 +66,8 @@ typedef struct employee {
 void getFilenameFromCommandLine(char filename[], int argc, const char *argv[]);
 
 /**
- * Reads the database from the given filename
+ * Reads the database from the given filename. Binary databases (see
+ * bindb.h) are mapped instead of parsed.
  *
  * @param db            the database
  * @param db_size       the database size
@@ -60,13 +76,36 @@ void getFilenameFromCommandLine(char filename[], int argc, const char *argv[]);
  */
 int read_database(employee_t ***db, size_t *db_size, char filename[]);
 
+/**
+ * Creates a new employee_t
+ *
+ * @param id            the employee's id
+ * @param first_name    the employee's first_name
+ * @param last_name     the employee's last_name
+ * @param salary        the employee's salary
+ * @return the new employee
+ */
+employee_t *new_employee(unsigned int id, char *first_name, char *last_name, unsigned int salary);
+
+/**
+ * Finds the index for the employee with the given id
+ *
+ * @param db            the database
+ * @param db_size       the database size
+ * @param id    employee's id
+ * @return index of employee, returns -1 if not found
+ */
+int find_by_id(employee_t **db, size_t db_size, int id);
+
 /**
  * The run loop
  *
  * @param db            the database
  * @param db_size       the database size
+ * @param salaries      the salary index over the database
+ * @param last_names    the last name index over the database
  * @return 0 if success -1 if fail
  */
-int run_loop(employee_t ***db, size_t *db_size);
+int run_loop(employee_t ***db, size_t *db_size, struct salary_index *salaries, struct name_index *last_names);
 
 #endif
@@ -0,0 +1,198 @@
+//
+//  db_bench.c
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+//  Mixed read/write benchmark for the concurrent db. Reader threads
+//  run id lookups, last name lookups and top-K queries while a single
+//  writer updates salaries and inserts/removes employees.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "core.h"
+#include "concurrent.h"
+
+#define TOP_K 10
+
+typedef struct worker {
+    cdb_t *cdb;
+    int slot;
+    unsigned int *ids;          // ids present at startup
+    size_t num_ids;
+    int *running;
+    unsigned long ops;
+} worker_t;
+
+/**
+ * xorshift random number generator
+ *
+ * @param state     pointer to the generator state
+ * @return the next random number
+ */
+unsigned int next_rand(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/**
+ * Reader thread: 8 id lookups, 1 last name lookup and 1 top-K query
+ * per round
+ *
+ * @param arg       the worker
+ */
+void *reader(void *arg) {
+    worker_t *w = arg;
+    unsigned int seed = 2463534242u + w->slot;
+    const employee_t *top[TOP_K];
+    unsigned long found = 0;
+
+    while (__atomic_load_n(w->running, __ATOMIC_RELAXED)) {
+        const snapshot_t *s = cdb_reader_enter(w->cdb, w->slot);
+
+        for (int i = 0; i < 8; i++) {
+            unsigned int id = w->ids[next_rand(&seed) % w->num_ids];
+            found += snapshot_find_by_id(s, id) != NULL;
+        }
+
+        const employee_t *e = snapshot_find_by_id(s, w->ids[next_rand(&seed) % w->num_ids]);
+        if (e) {
+            found += snapshot_find_by_last_name(s, e->last_name) != NULL;
+        }
+
+        found += snapshot_highest_salaries(s, TOP_K, top);
+
+        cdb_reader_exit(w->cdb, w->slot);
+        w->ops += 10;
+    }
+
+    // keep the lookups from being optimized away
+    if (found == 0) {
+        fprintf(stderr, "reader %d found nothing\n", w->slot);
+    }
+    return NULL;
+}
+
+/**
+ * Writer thread: salary updates with an occasional insert/remove of a
+ * temporary employee
+ *
+ * @param arg       the worker
+ */
+void *writer(void *arg) {
+    worker_t *w = arg;
+    unsigned int seed = 88172645u;
+
+    while (__atomic_load_n(w->running, __ATOMIC_RELAXED)) {
+        unsigned int id = w->ids[next_rand(&seed) % w->num_ids];
+        cdb_update_salary(w->cdb, id, 30000 + next_rand(&seed) % 120001);
+        w->ops++;
+
+        if (w->ops % 16 == 0) {
+            char *first = malloc(MAXNAME), *last = malloc(MAXNAME);
+            strcpy(first, "Temp");
+            strcpy(last, "Worker");
+            employee_t *e = new_employee(1000000 + w->ops % 1000, first, last, 50000);
+            if (cdb_insert(w->cdb, e) == 0) {
+                cdb_remove(w->cdb, e->id);
+            } else {
+                free(first);
+                free(last);
+                free(e);
+            }
+            w->ops += 2;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Returns the current time in seconds
+ *
+ * @return seconds since an arbitrary point
+ */
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+int main(int argc, const char * argv[])
+{
+    char filename[MAXFILENAME];
+    employee_t **db = NULL;
+    size_t db_size = 0;
+    int num_readers = 4;
+    double seconds = 2.0;
+
+    if (argc < 2 || argc > 4) {
+        printf("Usage: %s database_file [readers] [seconds]\n", argv[0]);
+        exit(1);
+    }
+    if (argc > 2) num_readers = atoi(argv[2]);
+    if (argc > 3) seconds = atof(argv[3]);
+    if (num_readers < 1 || num_readers >= CDB_MAX_READERS) {
+        printf("readers must be between 1 and %d\n", CDB_MAX_READERS - 1);
+        exit(1);
+    }
+
+    const char *args[2] = { argv[0], argv[1] };
+    getFilenameFromCommandLine(filename, 2, args);
+    if (read_database(&db, &db_size, filename)) return 1;
+    if (db_size == 0) {
+        printf("Database is empty\n");
+        return 1;
+    }
+
+    unsigned int *ids = malloc(sizeof(unsigned int)*db_size);
+    for (size_t i = 0; i < db_size; i++) {
+        ids[i] = db[i]->id;
+    }
+
+    cdb_t *cdb = cdb_open(db, db_size);
+    free(db);
+
+    int running = 1;
+    pthread_t threads[CDB_MAX_READERS];
+    worker_t workers[CDB_MAX_READERS];
+
+    for (int i = 0; i <= num_readers; i++) {
+        workers[i] = (worker_t){ cdb, i, ids, db_size, &running, 0 };
+        pthread_create(&threads[i], NULL, i < num_readers ? reader : writer, &workers[i]);
+    }
+
+    double start = now();
+    struct timespec ts = { (time_t)seconds, (long)((seconds - (time_t)seconds)*1e9) };
+    nanosleep(&ts, NULL);
+    __atomic_store_n(&running, 0, __ATOMIC_RELAXED);
+
+    for (int i = 0; i <= num_readers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now() - start;
+
+    unsigned long reads = 0;
+    for (int i = 0; i < num_readers; i++) {
+        reads += workers[i].ops;
+    }
+
+    printf("%-10s%-16s%-16s%-16s\n", "Readers", "Reads/s", "Reads/s/thread", "Writes/s");
+    printf("%-10d%-16.0f%-16.0f%-16.0f\n", num_readers, reads/elapsed,
+           reads/elapsed/num_readers, workers[num_readers].ops/elapsed);
+
+    cdb_close(cdb);
+    free(ids);
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+//
+//  db_convert.c
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+//  Converts a text database ("id first last salary" per line) to the
+//  binary format described in bindb.h.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "core.h"
+#include "bindb.h"
+
+int main(int argc, const char * argv[])
+{
+    char filename[MAXFILENAME];
+    employee_t **db = NULL;
+    size_t db_size = 0;
+
+    if (argc != 3) {
+        printf("Usage: %s text_database binary_database\n", argv[0]);
+        exit(1);
+    }
+
+    // read_database sorts by id, which builds the binary id index
+    const char *args[2] = { argv[0], argv[1] };
+    getFilenameFromCommandLine(filename, 2, args);
+    if (read_database(&db, &db_size, filename)) return 1;
+
+    // the binary id index needs each id once
+    for (size_t i = 1; i < db_size; i++) {
+        if (db[i - 1]->id == db[i]->id) {
+            fprintf(stderr, "Duplicate ID %u in %s\n", db[i]->id, argv[1]);
+            return 1;
+        }
+    }
+
+    if (bindb_write(argv[2], db, db_size)) {
+        fprintf(stderr, "Could not write file: %s\n", argv[2]);
+        return 1;
+    }
+
+    printf("Wrote %lu records to %s\n", db_size, argv[2]);
+    return 0;
+}
@@ -12,6 +12,8 @@
 #include <ctype.h>
 #include "readfile.h"
 #include "core.h"
+#include "salary_index.h"
+#include "name_index.h"
 
 int main(int argc, const char * argv[])
 {
@@ -27,5 +29,11 @@ int main(int argc, const char * argv[])
     db_result = read_database(&db, &db_size, filename);
     if (db_result) return db_result;
     
-    return run_loop(&db, &db_size);
+    // Index salaries for range and order-statistic queries
+    salary_index_t *salaries = salary_index_build(db, db_size);
+    
+    // Index last names for prefix and fuzzy search
+    name_index_t *last_names = name_index_build(db, db_size);
+    
+    return run_loop(&db, &db_size, salaries, last_names);
 }
@@ -0,0 +1,255 @@
+//
+//  name_index.c
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "name_index.h"
+
+/*** Node helpers ***/
+
+/**
+ * Finds the child of n labelled c, optionally creating it
+ *
+ * @param n         the parent
+ * @param c         the child's character (lower case)
+ * @param create    boolean to create a missing child
+ * @return the child, NULL if missing and not created
+ */
+name_node_t *find_child(name_node_t *n, char c, int create) {
+    name_node_t **link = &n->child;
+
+    while (*link && (*link)->c < c) {
+        link = &(*link)->sibling;
+    }
+    if (*link && (*link)->c == c) {
+        return *link;
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    name_node_t *child = calloc(1, sizeof(name_node_t));
+    child->c = c;
+    child->sibling = *link;
+    *link = child;
+    return child;
+}
+
+void free_nodes(name_node_t *n) {
+    while (n) {
+        name_node_t *next = n->sibling;
+        free_nodes(n->child);
+        free(n->employees);
+        free(n);
+        n = next;
+    }
+}
+
+/**
+ * Removes e from under key in the subtree of n, unlinking any node left
+ * with no employees and no children
+ *
+ * @param n         the subtree root
+ * @param key       the rest of the name
+ * @param e         the employee
+ */
+void remove_from(name_node_t *n, const char *key, employee_t *e) {
+    if (*key == '\0') {
+        for (size_t i = 0; i < n->size; i++) {
+            if (n->employees[i] == e) {
+                memmove(&n->employees[i], &n->employees[i + 1], sizeof(employee_t*)*(n->size - i - 1));
+                n->size--;
+                break;
+            }
+        }
+        return;
+    }
+
+    char c = (char)tolower((unsigned char)*key);
+    name_node_t **link = &n->child;
+    while (*link && (*link)->c != c) {
+        link = &(*link)->sibling;
+    }
+    if (!*link) return;
+
+    name_node_t *child = *link;
+    remove_from(child, key + 1, e);
+    if (child->size == 0 && !child->child) {
+        *link = child->sibling;
+        free(child->employees);
+        free(child);
+    }
+}
+
+size_t visit_all(name_node_t *n, void (*visit)(employee_t*)) {
+    size_t count = n->size;
+
+    for (size_t i = 0; i < n->size; i++) {
+        visit(n->employees[i]);
+    }
+    for (name_node_t *c = n->child; c; c = c->sibling) {
+        count += visit_all(c, visit);
+    }
+    return count;
+}
+
+/**
+ * Extends the edit distance row prev by one trie character and
+ * recurses while some entry is still within max_dist
+ *
+ * @param n         the node reached
+ * @param name      the (lower case) name to match
+ * @param len       its length
+ * @param prev      the row for n's parent
+ * @param max_dist  the distance bound
+ * @param visit     function pointer called with each employee and its distance
+ * @return the number of employees visited
+ */
+size_t fuzzy_from(name_node_t *n, const char *name, size_t len, const int *prev, int max_dist, void (*visit)(employee_t*, int)) {
+    int row[len + 1];
+    int best;
+    size_t count = 0;
+
+    row[0] = best = prev[0] + 1;
+    for (size_t j = 1; j <= len; j++) {
+        int del = prev[j] + 1;
+        int ins = row[j - 1] + 1;
+        int sub = prev[j - 1] + (name[j - 1] != n->c);
+        row[j] = del < ins ? del : ins;
+        if (sub < row[j]) row[j] = sub;
+        if (row[j] < best) best = row[j];
+    }
+
+    if (row[len] <= max_dist) {
+        for (size_t i = 0; i < n->size; i++) {
+            visit(n->employees[i], row[len]);
+        }
+        count += n->size;
+    }
+    if (best <= max_dist) {
+        for (name_node_t *c = n->child; c; c = c->sibling) {
+            count += fuzzy_from(c, name, len, row, max_dist, visit);
+        }
+    }
+    return count;
+}
+
+/*** Index functions ***/
+
+/**
+ * Builds a last name index over the db
+ *
+ * @param db            the database
+ * @param db_size       the database size
+ * @return the new index
+ */
+name_index_t *name_index_build(employee_t **db, size_t db_size) {
+    name_index_t *idx = calloc(1, sizeof(name_index_t));
+
+    for (size_t i = 0; i < db_size; i++) {
+        name_index_insert(idx, db[i]->last_name, db[i]);
+    }
+    return idx;
+}
+
+/**
+ * Frees the index, but not the employees in it
+ *
+ * @param idx           the index
+ */
+void name_index_free(name_index_t *idx) {
+    free_nodes(idx->root.child);
+    free(idx->root.employees);
+    free(idx);
+}
+
+/**
+ * Adds an employee under the given name
+ *
+ * @param idx           the index
+ * @param name          the name
+ * @param e             the employee
+ */
+void name_index_insert(name_index_t *idx, const char *name, employee_t *e) {
+    name_node_t *n = &idx->root;
+
+    for (; *name; name++) {
+        n = find_child(n, (char)tolower((unsigned char)*name), 1);
+    }
+
+    if (n->size == n->capacity) {
+        n->capacity = n->capacity ? n->capacity*2 : 1;
+        n->employees = realloc(n->employees, sizeof(employee_t*)*n->capacity);
+    }
+    n->employees[n->size++] = e;
+}
+
+/**
+ * Removes an employee from under the given name
+ *
+ * @param idx           the index
+ * @param name          the name it was inserted with
+ * @param e             the employee
+ */
+void name_index_remove(name_index_t *idx, const char *name, employee_t *e) {
+    remove_from(&idx->root, name, e);
+}
+
+/**
+ * Calls visit on every employee whose name starts with prefix, in
+ * name order
+ *
+ * @param idx           the index
+ * @param prefix        the prefix
+ * @param visit         function pointer called with each employee
+ * @return the number of employees visited
+ */
+size_t name_index_prefix(name_index_t *idx, const char *prefix, void (*visit)(employee_t*)) {
+    name_node_t *n = &idx->root;
+
+    for (; *prefix && n; prefix++) {
+        n = find_child(n, (char)tolower((unsigned char)*prefix), 0);
+    }
+    return n ? visit_all(n, visit) : 0;
+}
+
+/**
+ * Calls visit on every employee whose name is within max_dist edits
+ * (insertions, deletions, substitutions) of name, in name order
+ *
+ * @param idx           the index
+ * @param name          the name to match
+ * @param max_dist      the largest edit distance to accept
+ * @param visit         function pointer called with each employee and its distance
+ * @return the number of employees visited
+ */
+size_t name_index_fuzzy(name_index_t *idx, const char *name, int max_dist, void (*visit)(employee_t*, int)) {
+    size_t len = strlen(name);
+    char lower[len + 1];
+    int row[len + 1];
+    size_t count = 0;
+
+    for (size_t j = 0; j <= len; j++) {
+        lower[j] = (char)tolower((unsigned char)name[j]);
+        row[j] = (int)j;
+    }
+
+    // the empty name is only relevant if len <= max_dist
+    if ((int)len <= max_dist) {
+        for (size_t i = 0; i < idx->root.size; i++) {
+            visit(idx->root.employees[i], (int)len);
+        }
+        count += idx->root.size;
+    }
+    for (name_node_t *c = idx->root.child; c; c = c->sibling) {
+        count += fuzzy_from(c, lower, len, row, max_dist, visit);
+    }
+    return count;
+}
@@ -0,0 +1,96 @@
+//
+//  name_index.h
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#ifndef employee_db_name_index_h
+#define employee_db_name_index_h
+
+#include <stddef.h>
+#include "core.h"
+
+/*
+ * A case-insensitive trie from names to employees. Children are kept
+ * as a sibling list sorted by character, so a node costs the same no
+ * matter how many distinct characters the names use.
+ *
+ * Prefix queries walk |prefix| nodes and then visit only the matching
+ * subtree. Fuzzy queries carry one row of the Levenshtein table down
+ * each branch and prune a branch as soon as every entry in the row
+ * exceeds the distance bound.
+ */
+
+typedef struct name_node {
+    char c;
+    employee_t **employees;     // employees whose name ends here
+    size_t size;
+    size_t capacity;
+    struct name_node *child;    // first child
+    struct name_node *sibling;  // next child of the parent
+} name_node_t;
+
+typedef struct name_index {
+    name_node_t root;
+} name_index_t;
+
+/**
+ * Builds a last name index over the db
+ *
+ * @param db            the database
+ * @param db_size       the database size
+ * @return the new index
+ */
+name_index_t *name_index_build(employee_t **db, size_t db_size);
+
+/**
+ * Frees the index, but not the employees in it
+ *
+ * @param idx           the index
+ */
+void name_index_free(name_index_t *idx);
+
+/**
+ * Adds an employee under the given name
+ *
+ * @param idx           the index
+ * @param name          the name
+ * @param e             the employee
+ */
+void name_index_insert(name_index_t *idx, const char *name, employee_t *e);
+
+/**
+ * Removes an employee from under the given name
+ *
+ * @param idx           the index
+ * @param name          the name it was inserted with
+ * @param e             the employee
+ */
+void name_index_remove(name_index_t *idx, const char *name, employee_t *e);
+
+/**
+ * Calls visit on every employee whose name starts with prefix, in
+ * name order
+ *
+ * @param idx           the index
+ * @param prefix        the prefix
+ * @param visit         function pointer called with each employee
+ * @return the number of employees visited
+ */
+size_t name_index_prefix(name_index_t *idx, const char *prefix, void (*visit)(employee_t*));
+
+/**
+ * Calls visit on every employee whose name is within max_dist edits
+ * (insertions, deletions, substitutions) of name, in name order
+ *
+ * @param idx           the index
+ * @param name          the name to match
+ * @param max_dist      the largest edit distance to accept
+ * @param visit         function pointer called with each employee and its distance
+ * @return the number of employees visited
+ */
+size_t name_index_fuzzy(name_index_t *idx, const char *name, int max_dist, void (*visit)(employee_t*, int));
+
+#endif
@@ -1,6 +1,6 @@
 /*
  * This is a library for reading values of different types from a file.
- * It is used as helper code for lab 1 in COMP280 @ USD.
+ * It is used as helper code for multiple labs in COMP280 @ USD.
 
  * See the associated header (readfile.h) for instructions on how to use this
  * library.
@@ -8,55 +8,398 @@
  * WARNING: It is not a particularly safe version of reading functions...
  * but neither is fscanf...
  *
+ * The file is read in large blocks into a buffer and numbers are parsed
+ * straight out of it, rather than with one fscanf call per value. Each
+ * reader_t has its own file and buffer, so readers on different files
+ * can be used from different threads at once.
+ *
+ * Each lab ships its own copy of readfile.c and readfile.h, so that every
+ * lab directory builds and is handed out on its own. The copies are kept
+ * identical; change them together.
  */
 #include <stdio.h>      // the C standard I/O library
 #include <stdlib.h>     // the C standard library
 #include <string.h>     // the C string library
-#include "readfile.h"   
+#include <stdint.h>
+#include <float.h>
+#include "readfile.h"
+
+#define BUF_SIZE (1 << 16)
+
+/* Tokens at most this long are parsed from the stack by the slow path */
+#define MAX_TOKEN 512
+
+struct reader {
+	FILE *file;
+	char *buf;
+	size_t pos;         // next unread byte in buf
+	size_t len;         // bytes of buf holding file data
+	int at_eof;
+};
+
+// The reader used by openFile() and the other global functions. You are
+// not allowed to use global variables in your program, so do not
+// emmulate this.
+static reader_t *global=0;
+
+/* Powers of ten that are exact doubles */
+static const double pow10_exact[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static int isSpace(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
 
-// These are global variables. You are not allowed to use
-// global variables in your program, so do not emmulate this.
-static FILE *infile=0;
-static int  is_inited=0; 
+static int isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
 
 /*
- * reads the next value in the file as a string
+ * moves the unread bytes to the front of the buffer and reads more
+ * @param r the reader
+ * @return the number of bytes read, 0 at the end of the file
+ */
+static size_t fill(reader_t *r) {
+	memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+	r->len -= r->pos;
+	r->pos = 0;
+
+	size_t n = fread(r->buf + r->len, 1, BUF_SIZE - r->len, r->file);
+	if (n == 0) {
+		r->at_eof = 1;
+	}
+	r->len += n;
+	return n;
+}
+
+/*
+ * skips whitespace
+ * @param r the reader
+ * @return 0 if a token follows, -1 at the end of the file
+ */
+static int skipSpace(reader_t *r) {
+	for (;;) {
+		while (r->pos < r->len && isSpace(r->buf[r->pos])) r->pos++;
+		if (r->pos < r->len) {
+			return 0;
+		}
+		if (r->at_eof || fill(r) == 0) {
+			return -1;
+		}
+	}
+}
+
+/*
+ * makes sure the whole token at pos is in the buffer (or as much of it
+ * as fits)
+ * @param r the reader
+ * @return the length of the token
+ */
+static size_t tokenLength(reader_t *r) {
+	size_t q = r->pos;
+	for (;;) {
+		while (q < r->len && !isSpace(r->buf[q])) q++;
+		if (q < r->len || r->at_eof || (r->pos == 0 && r->len == BUF_SIZE)) {
+			return q - r->pos;
+		}
+		size_t seen = q - r->pos;
+		fill(r);
+		q = r->pos + seen;
+	}
+}
+
+/*
+ * parses a number with strtod, which handles every form fscanf does
+ */
+static int parseSlow(const char *s, int n, double *val) {
+	char small[MAX_TOKEN + 1];
+	char *copy = n <= MAX_TOKEN ? small : malloc(n + 1);
+	char *endp;
+
+	memcpy(copy, s, n);
+	copy[n] = '\0';
+	*val = strtod(copy, &endp);
+	n = endp - copy;
+
+	if (copy != small) {
+		free(copy);
+	}
+	return n;
+}
+
+/*
+ * parses a double from the start of a string that need not be NUL
+ * terminated
+ *
+ * Plain decimals with at most 19 significant digits and a small
+ * exponent are converted with a single exact multiply or divide, which
+ * rounds correctly (Clinger's fast path). Anything else -- more digits,
+ * huge exponents, hex, inf, nan -- goes to strtod.
+ *
+ * @param s the characters
+ * @param n how many characters may be read
+ * @param val the value to "return"
+ * @return the number of characters used, 0 if s does not start with
+ *         a number
+ */
+int parseDouble(const char *s, int n, double *val) {
+	const char *p = s;
+	const char *end = s + n;
+	int neg = 0;
+
+	if (p < end && (*p == '+' || *p == '-')) {
+		neg = (*p == '-');
+		p++;
+	}
+	/* hex floats */
+	if (end - p >= 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+		return parseSlow(s, n, val);
+	}
+
+	uint64_t mant = 0;
+	int digits = 0;         // significant digits kept in mant
+	int exp10 = 0;
+	int any = 0;
+	int inexact = 0;        // a nonzero digit did not fit in mant
+
+	for (; p < end && isDigit(*p); p++) {
+		any = 1;
+		if (digits < 19) {
+			mant = mant*10 + (*p - '0');
+			if (mant) digits++;
+		} else {
+			exp10++;
+			inexact |= (*p != '0');
+		}
+	}
+	if (p < end && *p == '.') {
+		p++;
+		for (; p < end && isDigit(*p); p++) {
+			any = 1;
+			if (digits < 19) {
+				mant = mant*10 + (*p - '0');
+				if (mant) digits++;
+				exp10--;
+			} else {
+				inexact |= (*p != '0');
+			}
+		}
+	}
+	if (!any) {
+		/* inf, nan or not a number at all */
+		return parseSlow(s, n, val);
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char *q = p + 1;
+		int eneg = 0;
+		int e = 0;
+		if (q < end && (*q == '+' || *q == '-')) {
+			eneg = (*q == '-');
+			q++;
+		}
+		if (q < end && isDigit(*q)) {
+			for (; q < end && isDigit(*q); q++) {
+				if (e < 100000) e = e*10 + (*q - '0');
+			}
+			exp10 += eneg ? -e : e;
+			p = q;
+		}
+	}
+
+#if FLT_EVAL_METHOD == 0
+	/* Exact when mant and the power of ten are both exact doubles and
+	   the arithmetic is done in double precision */
+	if (!inexact && mant <= (UINT64_C(1) << 53)) {
+		double d = (double)mant;
+		if (mant == 0 || exp10 == 0) {
+			*val = neg ? -d : d;
+			return p - s;
+		}
+		if (exp10 < 0 && exp10 >= -22) {
+			d /= pow10_exact[-exp10];
+			*val = neg ? -d : d;
+			return p - s;
+		}
+		if (exp10 > 0 && exp10 <= 22 + 15) {
+			/* 1234e30 is 1234000000000000e22 */
+			if (exp10 > 22) {
+				d *= pow10_exact[exp10 - 22];
+				if (d > (double)(UINT64_C(1) << 53)) {
+					return parseSlow(s, n, val);
+				}
+				exp10 = 22;
+			}
+			d *= pow10_exact[exp10];
+			*val = neg ? -d : d;
+			return p - s;
+		}
+	}
+#endif
+
+	return parseSlow(s, n, val);
+}
+
+/*
+ * opens a file for reading
+ * @param filename a string containing the name of the file to read
+ * @return the reader, NULL if the file cannot be opened
+ */
+reader_t *reader_open(char *filename) {
+	FILE *file = fopen(filename, "r");
+	if (!file) {
+		return NULL;
+	}
+
+	reader_t *r = malloc(sizeof(reader_t));
+	if (!r) {
+		fclose(file);
+		return NULL;
+	}
+	r->buf = malloc(BUF_SIZE);
+	if (!r->buf) {
+		free(r);
+		fclose(file);
+		return NULL;
+	}
+	r->file = file;
+	r->pos = 0;
+	r->len = 0;
+	r->at_eof = 0;
+	return r;
+}
+
+/*
+ * closes a reader
+ * @param r the reader
+ */
+void reader_close(reader_t *r) {
+	fclose(r->file);
+	free(r->buf);
+	free(r);
+}
+
+/*
+ * reads the next value as a string
+ * @param r the reader
  * @param str a string to fill with the read in value
  * @return 0 on success, -1 if there is nothing left to
  *            read in the file
  */
-int readString(char str[]) {
-	int ret;
+int reader_string(reader_t *r, char str[]) {
+	if (skipSpace(r) == -1) {
+		return -1;
+	}
 
-	if (!is_inited) {
+	int i = 0;
+	for (;;) {
+		while (r->pos < r->len && !isSpace(r->buf[r->pos])) {
+			str[i++] = r->buf[r->pos++];
+		}
+		if (r->pos < r->len || r->at_eof || fill(r) == 0) {
+			break;
+		}
+	}
+	str[i] = '\0';
+	return 0;
+}
+
+/*
+ * reads the next value as an int
+ * @param r the reader
+ * @param val the value to "return"
+ * @return 0 on success, -1 if there is nothing left to
+ *            read in the file
+ */
+int reader_int(reader_t *r, int *val) {
+	if (skipSpace(r) == -1) {
 		return -1;
 	}
-	ret = fscanf(infile, "%s", str);
-	if (ret != 1) { 
+
+	const char *p = r->buf + r->pos;
+	const char *end = p + tokenLength(r);
+	int neg = 0;
+	unsigned int x = 0;
+
+	if (p < end && (*p == '+' || *p == '-')) {
+		neg = (*p == '-');
+		p++;
+	}
+	if (p == end || !isDigit(*p)) {
 		return -1;
 	}
+	for (; p < end && isDigit(*p); p++) {
+		x = x*10 + (*p - '0');
+	}
+
+	*val = (int)(neg ? 0u - x : x);
+	r->pos = p - r->buf;
 	return 0;
 }
 
 /*
- * reads the next value in the file as an int
+ * reads the next value as a double
+ * @param r the reader
  * @param val the value to "return"
  * @return 0 on success, -1 if there is nothing left to
  *            read in the file
  */
-int readInt(int *val) {
-	int ret;
-
-	if (!is_inited) {
+int reader_double(reader_t *r, double *val) {
+	if (skipSpace(r) == -1) {
 		return -1;
 	}
-	ret = fscanf(infile, "%d", val);
-	if (ret != 1) { 
+
+	int used = parseDouble(r->buf + r->pos, tokenLength(r), val);
+	if (used == 0) {
 		return -1;
 	}
+	r->pos += used;
 	return 0;
 }
 
+/*
+ * reads up to n values as doubles
+ * @param r the reader
+ * @param vals array of at least n values to fill
+ * @param n the number of values wanted
+ * @return the number of values read
+ */
+int reader_doubles(reader_t *r, double *vals, int n) {
+	int i = 0;
+	while (i < n && reader_double(r, &vals[i]) == 0) {
+		i++;
+	}
+	return i;
+}
+
+/*
+ * reads the next value in the file as a string
+ * @param str a string to fill with the read in value
+ * @return 0 on success, -1 if there is nothing left to
+ *            read in the file
+ */
+int readString(char str[]) {
+	if (!global) {
+		return -1;
+	}
+	return reader_string(global, str);
+}
+
+/*
+ * reads the next value in the file as an int
+ * @param val the value to "return"
+ * @return 0 on success, -1 if there is nothing left to
+ *            read in the file
+ */
+int readInt(int *val) {
+	if (!global) {
+		return -1;
+	}
+	return reader_int(global, val);
+}
+
 /*
  * reads the next value in the file as a double
  * @param val the value to "return"
@@ -64,16 +407,24 @@ int readInt(int *val) {
  *            read in the file
  */
 int readDouble(double *val) {
-	int ret;
-
-	if (!is_inited) {
+	if (!global) {
 		return -1;
 	}
-	ret = fscanf(infile, "%lf", val);
-	if (ret != 1) { 
-		return -1;
+	return reader_double(global, val);
+}
+
+/*
+ * reads up to n values in the file as doubles
+ * @param vals array of at least n values to fill
+ * @param n the number of values wanted
+ * @return the number of values read, less than n only at the end of
+ *         the file or a value that is not a number
+ */
+int readDoubles(double *vals, int n) {
+	if (!global) {
+		return 0;
 	}
-	return 0;
+	return reader_doubles(global, vals, n);
 }
 
 /*
@@ -84,11 +435,13 @@ int readDouble(double *val) {
  */
 int openFile(char *filename) {
 
-	infile = fopen(filename, "r");
-	if (!infile) {
+	if (global) {
+		reader_close(global);
+	}
+	global = reader_open(filename);
+	if (!global) {
 		return -1;
 	}
-	is_inited = 1;
 	return 0;
 }
 
@@ -97,8 +450,8 @@ int openFile(char *filename) {
  */
 void closeFile() {
 
-	if (infile) {
-		fclose(infile);
+	if (global) {
+		reader_close(global);
 	}
-	is_inited = 0;
+	global = 0;
 }
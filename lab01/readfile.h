@@ -37,8 +37,20 @@
  *
  *   (3) call closeFile() when you are all done reading values
  *       from the file
+ *
+ * The functions above read one file at a time. To read several, or to
+ * read from more than one thread, open a reader_t for each file with
+ * reader_open() and use the reader_<type> functions instead:
+ *
+ *       reader_t *r = reader_open("input.txt");
+ *       while(reader_int(r, &x) != -1) {
+ *         total += x;
+ *       }
+ *       reader_close(r);
  */
 
+typedef struct reader reader_t;
+
 
 /*
  * open the file for reading
@@ -77,4 +89,48 @@ int readInt(int *val);
  */
 int readDouble(double *val);
 
+/*
+ * reads up to n values in the file as doubles
+ * @param vals array of at least n values to fill
+ * @param n the number of values wanted
+ * @return the number of values read, less than n only at the end of
+ *         the file or a value that is not a number
+ */
+int readDoubles(double *vals, int n);
+
+/*
+ * parses a double from the start of a string, like strtod but without
+ * needing a NUL terminator
+ * @param s the characters
+ * @param n how many characters may be read
+ * @param val the value to "return"
+ * @return the number of characters used, 0 if s does not start with
+ *            a number
+ */
+int parseDouble(const char *s, int n, double *val);
+
+/*
+ * opens a file for reading with its own buffer
+ * @param filename a string containing the name of the file to read
+ * @return the reader, NULL if the file cannot be opened
+ */
+reader_t *reader_open(char *filename);
+
+/*
+ * closes a reader
+ * @param r the reader
+ */
+void reader_close(reader_t *r);
+
+/*
+ * reader_string, reader_int, reader_double and reader_doubles work
+ * like readString, readInt, readDouble and readDoubles on the reader's
+ * file
+ * @param r the reader
+ */
+int reader_string(reader_t *r, char str[]);
+int reader_int(reader_t *r, int *val);
+int reader_double(reader_t *r, double *val);
+int reader_doubles(reader_t *r, double *vals, int n);
+
 #endif
@@ -0,0 +1,348 @@
+//
+//  salary_index.c
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "salary_index.h"
+
+/*** Node helpers ***/
+
+int node_height(salary_node_t *n) {
+    return n ? n->height : 0;
+}
+
+size_t node_size(salary_node_t *n) {
+    return n ? n->size : 0;
+}
+
+unsigned long long node_sum(salary_node_t *n) {
+    return n ? n->sum : 0;
+}
+
+/**
+ * Recomputes the height, size and sum of a node from its children
+ *
+ * @param n     the node
+ */
+void node_update(salary_node_t *n) {
+    int hl = node_height(n->left), hr = node_height(n->right);
+    n->height = 1 + (hl > hr ? hl : hr);
+    n->size = 1 + node_size(n->left) + node_size(n->right);
+    n->sum = n->salary + node_sum(n->left) + node_sum(n->right);
+}
+
+/**
+ * Compares a (salary, id) key against a node
+ *
+ * @return negative, zero or positive like strcmp
+ */
+int node_cmp(unsigned int salary, unsigned int id, salary_node_t *n) {
+    if (salary != n->salary) return salary < n->salary ? -1 : 1;
+    if (id != n->id) return id < n->id ? -1 : 1;
+    return 0;
+}
+
+salary_node_t *rotate_right(salary_node_t *n) {
+    salary_node_t *l = n->left;
+    n->left = l->right;
+    l->right = n;
+    node_update(n);
+    node_update(l);
+    return l;
+}
+
+salary_node_t *rotate_left(salary_node_t *n) {
+    salary_node_t *r = n->right;
+    n->right = r->left;
+    r->left = n;
+    node_update(n);
+    node_update(r);
+    return r;
+}
+
+/**
+ * Restores the AVL balance of a node whose children are balanced
+ *
+ * @param n     the node
+ * @return the new subtree root
+ */
+salary_node_t *rebalance(salary_node_t *n) {
+    node_update(n);
+    int balance = node_height(n->left) - node_height(n->right);
+
+    if (balance > 1) {
+        if (node_height(n->left->left) < node_height(n->left->right)) {
+            n->left = rotate_left(n->left);
+        }
+        return rotate_right(n);
+    }
+    if (balance < -1) {
+        if (node_height(n->right->right) < node_height(n->right->left)) {
+            n->right = rotate_right(n->right);
+        }
+        return rotate_left(n);
+    }
+    return n;
+}
+
+salary_node_t *node_insert(salary_node_t *n, employee_t *e) {
+    if (!n) {
+        n = malloc(sizeof(salary_node_t));
+        n->e = e;
+        n->salary = e->salary;
+        n->id = e->id;
+        n->left = n->right = NULL;
+        node_update(n);
+        return n;
+    }
+
+    if (node_cmp(e->salary, e->id, n) < 0) {
+        n->left = node_insert(n->left, e);
+    } else {
+        n->right = node_insert(n->right, e);
+    }
+    return rebalance(n);
+}
+
+/**
+ * Detaches the minimum node of a subtree
+ *
+ * @param n     the subtree
+ * @param min   set to the detached node
+ * @return the new subtree root
+ */
+salary_node_t *node_remove_min(salary_node_t *n, salary_node_t **min) {
+    if (!n->left) {
+        *min = n;
+        return n->right;
+    }
+    n->left = node_remove_min(n->left, min);
+    return rebalance(n);
+}
+
+salary_node_t *node_remove(salary_node_t *n, unsigned int salary, unsigned int id) {
+    if (!n) return NULL;
+
+    int c = node_cmp(salary, id, n);
+    if (c < 0) {
+        n->left = node_remove(n->left, salary, id);
+    } else if (c > 0) {
+        n->right = node_remove(n->right, salary, id);
+    } else {
+        salary_node_t *l = n->left, *r = n->right, *min;
+        free(n);
+        if (!r) return l;
+        r = node_remove_min(r, &min);
+        min->left = l;
+        min->right = r;
+        return rebalance(min);
+    }
+    return rebalance(n);
+}
+
+void node_free(salary_node_t *n) {
+    if (n) {
+        node_free(n->left);
+        node_free(n->right);
+        free(n);
+    }
+}
+
+/**
+ * Counts and sums the salaries below salary, or at most salary when
+ * inclusive is set
+ *
+ * @param n             the root
+ * @param salary        the bound
+ * @param inclusive     whether salary itself is included
+ * @param sum           set to the sum of the counted salaries
+ * @return the count
+ */
+size_t rank_below(salary_node_t *n, unsigned int salary, int inclusive, unsigned long long *sum) {
+    size_t count = 0;
+    *sum = 0;
+
+    while (n) {
+        if (n->salary < salary || (inclusive && n->salary == salary)) {
+            count += node_size(n->left) + 1;
+            *sum += node_sum(n->left) + n->salary;
+            n = n->right;
+        } else {
+            n = n->left;
+        }
+    }
+    return count;
+}
+
+void node_range(salary_node_t *n, unsigned int min, unsigned int max, void (*visit)(employee_t*)) {
+    if (!n) return;
+    if (n->salary >= min) node_range(n->left, min, max, visit);
+    if (n->salary >= min && n->salary <= max) visit(n->e);
+    if (n->salary <= max) node_range(n->right, min, max, visit);
+}
+
+/*** Index functions ***/
+
+/**
+ * Builds a salary index over the db
+ *
+ * @param db            the database
+ * @param db_size       the database size
+ * @return the new index
+ */
+salary_index_t *salary_index_build(employee_t **db, size_t db_size) {
+    salary_index_t *idx = malloc(sizeof(salary_index_t));
+    idx->root = NULL;
+
+    for (size_t i = 0; i < db_size; i++) {
+        salary_index_insert(idx, db[i]);
+    }
+    return idx;
+}
+
+/**
+ * Frees the index, but not the employees in it
+ *
+ * @param idx           the index
+ */
+void salary_index_free(salary_index_t *idx) {
+    node_free(idx->root);
+    free(idx);
+}
+
+/**
+ * Adds an employee to the index
+ *
+ * @param idx           the index
+ * @param e             the employee
+ */
+void salary_index_insert(salary_index_t *idx, employee_t *e) {
+    idx->root = node_insert(idx->root, e);
+}
+
+/**
+ * Removes an employee from the index
+ *
+ * @param idx           the index
+ * @param e             the employee, with the salary and id it was inserted with
+ */
+void salary_index_remove(salary_index_t *idx, employee_t *e) {
+    idx->root = node_remove(idx->root, e->salary, e->id);
+}
+
+/**
+ * Number of employees in the index
+ *
+ * @param idx           the index
+ * @return the count
+ */
+size_t salary_index_size(salary_index_t *idx) {
+    return node_size(idx->root);
+}
+
+/**
+ * Finds the employee with the k-th lowest salary
+ *
+ * @param idx           the index
+ * @param k             0-based rank
+ * @return the employee, NULL if k is out of range
+ */
+employee_t *salary_index_kth(salary_index_t *idx, size_t k) {
+    salary_node_t *n = idx->root;
+
+    while (n) {
+        size_t left = node_size(n->left);
+        if (k < left) {
+            n = n->left;
+        } else if (k == left) {
+            return n->e;
+        } else {
+            k -= left + 1;
+            n = n->right;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Counts the employees with min <= salary <= max
+ *
+ * @param idx           the index
+ * @param min           lowest salary
+ * @param max           highest salary
+ * @return the count
+ */
+size_t salary_index_count_range(salary_index_t *idx, unsigned int min, unsigned int max) {
+    unsigned long long sum;
+    if (min > max) return 0;
+    return rank_below(idx->root, max, 1, &sum) - rank_below(idx->root, min, 0, &sum);
+}
+
+/**
+ * Sums the salaries with min <= salary <= max
+ *
+ * @param idx           the index
+ * @param min           lowest salary
+ * @param max           highest salary
+ * @return the sum
+ */
+unsigned long long salary_index_sum_range(salary_index_t *idx, unsigned int min, unsigned int max) {
+    unsigned long long upper, lower;
+    if (min > max) return 0;
+    rank_below(idx->root, max, 1, &upper);
+    rank_below(idx->root, min, 0, &lower);
+    return upper - lower;
+}
+
+/**
+ * Calls visit on every employee with min <= salary <= max, in
+ * ascending salary order
+ *
+ * @param idx           the index
+ * @param min           lowest salary
+ * @param max           highest salary
+ * @param visit         function pointer called with each employee
+ */
+void salary_index_range(salary_index_t *idx, unsigned int min, unsigned int max, void (*visit)(employee_t*)) {
+    node_range(idx->root, min, max, visit);
+}
+
+/**
+ * Finds the median salary
+ *
+ * @param idx           the index
+ * @return the median, 0 if the index is empty
+ */
+double salary_index_median(salary_index_t *idx) {
+    size_t n = salary_index_size(idx);
+    if (n == 0) return 0;
+
+    if (n%2 == 0) {
+        return (salary_index_kth(idx, n/2 - 1)->salary + (double)salary_index_kth(idx, n/2)->salary)/2.0;
+    }
+    return salary_index_kth(idx, n/2)->salary;
+}
+
+/**
+ * Finds the employee at the given percentile (nearest rank)
+ *
+ * @param idx           the index
+ * @param p             percentile, 0 < p <= 100
+ * @return the employee, NULL if the index is empty
+ */
+employee_t *salary_index_percentile(salary_index_t *idx, double p) {
+    size_t n = salary_index_size(idx);
+    if (n == 0) return NULL;
+
+    double r = p/100.0*n;
+    size_t rank = (size_t)r;
+    if (rank < r) rank++;
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return salary_index_kth(idx, rank - 1);
+}
@@ -0,0 +1,137 @@
+//
+//  salary_index.h
+//  employee_db
+//
+//  Created by Jeremy Jacobson on 10/19/26.
+//  Copyright (c) 2026 Jeremy Jacobson. All rights reserved.
+//
+
+#ifndef employee_db_salary_index_h
+#define employee_db_salary_index_h
+
+#include <stddef.h>
+#include "core.h"
+
+/*
+ * An AVL tree of employees ordered by (salary, id). Every node keeps
+ * the size and salary sum of its subtree, so rank, k-th order and
+ * range count/sum queries are O(log n).
+ *
+ * Nodes copy the salary and id of their employee, so an employee must
+ * be removed from the index before either field is changed and
+ * inserted again afterwards.
+ */
+
+typedef struct salary_node {
+    employee_t *e;
+    unsigned int salary;
+    unsigned int id;
+    int height;
+    size_t size;
+    unsigned long long sum;
+    struct salary_node *left;
+    struct salary_node *right;
+} salary_node_t;
+
+typedef struct salary_index {
+    salary_node_t *root;
+} salary_index_t;
+
+/**
+ * Builds a salary index over the db
+ *
+ * @param db            the database
+ * @param db_size       the database size
+ * @return the new index
+ */
+salary_index_t *salary_index_build(employee_t **db, size_t db_size);
+
+/**
+ * Frees the index, but not the employees in it
+ *
+ * @param idx           the index
+ */
+void salary_index_free(salary_index_t *idx);
+
+/**
+ * Adds an employee to the index
+ *
+ * @param idx           the index
+ * @param e             the employee
+ */
+void salary_index_insert(salary_index_t *idx, employee_t *e);
+
+/**
+ * Removes an employee from the index
+ *
+ * @param idx           the index
+ * @param e             the employee, with the salary and id it was inserted with
+ */
+void salary_index_remove(salary_index_t *idx, employee_t *e);
+
+/**
+ * Number of employees in the index
+ *
+ * @param idx           the index
+ * @return the count
+ */
+size_t salary_index_size(salary_index_t *idx);
+
+/**
+ * Finds the employee with the k-th lowest salary
+ *
+ * @param idx           the index
+ * @param k             0-based rank
+ * @return the employee, NULL if k is out of range
+ */
+employee_t *salary_index_kth(salary_index_t *idx, size_t k);
+
+/**
+ * Counts the employees with min <= salary <= max
+ *
+ * @param idx           the index
+ * @param min           lowest salary
+ * @param max           highest salary
+ * @return the count
+ */
+size_t salary_index_count_range(salary_index_t *idx, unsigned int min, unsigned int max);
+
+/**
+ * Sums the salaries with min <= salary <= max
+ *
+ * @param idx           the index
+ * @param min           lowest salary
+ * @param max           highest salary
+ * @return the sum
+ */
+unsigned long long salary_index_sum_range(salary_index_t *idx, unsigned int min, unsigned int max);
+
+/**
+ * Calls visit on every employee with min <= salary <= max, in
+ * ascending salary order
+ *
+ * @param idx           the index
+ * @param min           lowest salary
+ * @param max           highest salary
+ * @param visit         function pointer called with each employee
+ */
+void salary_index_range(salary_index_t *idx, unsigned int min, unsigned int max, void (*visit)(employee_t*));
+
+/**
+ * Finds the median salary
+ *
+ * @param idx           the index
+ * @return the median, 0 if the index is empty
+ */
+double salary_index_median(salary_index_t *idx);
+
+/**
+ * Finds the employee at the given percentile (nearest rank)
+ *
+ * @param idx           the index
+ * @param p             percentile, 0 < p <= 100
+ * @return the employee, NULL if the index is empty
+ */
+employee_t *salary_index_percentile(salary_index_t *idx, double p);
+
+#endif
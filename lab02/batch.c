@@ -0,0 +1,100 @@
+/*
+ * CS:APP Data Lab
+ *
+ * batch.c - Batched evaluation of the puzzle functions for btest.
+ *
+ * This file is a unity build: it includes bits.c and tests.c, so that
+ * each wrapper loop below can inline its puzzle rather than calling it
+ * through a function pointer, and the straight-line bit manipulation
+ * can be vectorized. The Makefile compiles it in place of bits.c and
+ * tests.c, with optimization turned up.
+ */
+#include <string.h>
+#include "bits.c"
+#include "tests.c"
+#include "batch.h"
+
+/* Wrappers for functions of one, two or three int-sized arguments. r
+   is restrict and the argument arrays are read through const locals,
+   so the loops can be vectorized without alias checks */
+#define BATCH1(f)							\
+    static void batch_##f(int *args[3], int *restrict r, int n)	\
+    {									\
+	const int *a0 = args[0];					\
+	int i;								\
+	for (i = 0; i < n; i++)						\
+	    r[i] = f(a0[i]);						\
+    }
+
+#define BATCH2(f)							\
+    static void batch_##f(int *args[3], int *restrict r, int n)	\
+    {									\
+	const int *a0 = args[0], *a1 = args[1];				\
+	int i;								\
+	for (i = 0; i < n; i++)						\
+	    r[i] = f(a0[i], a1[i]);					\
+    }
+
+#define BATCH3(f)							\
+    static void batch_##f(int *args[3], int *restrict r, int n)	\
+    {									\
+	const int *a0 = args[0], *a1 = args[1], *a2 = args[2];		\
+	int i;								\
+	for (i = 0; i < n; i++)						\
+	    r[i] = f(a0[i], a1[i], a2[i]);				\
+    }
+
+/* A puzzle and its reference */
+#define PUZZLE1(f) BATCH1(f) BATCH1(test_##f)
+#define PUZZLE2(f) BATCH2(f) BATCH2(test_##f)
+#define PUZZLE3(f) BATCH3(f) BATCH3(test_##f)
+#define ENTRY(f) {#f, batch_##f, batch_test_##f}
+
+PUZZLE1(isZero)
+PUZZLE2(bitOr)
+PUZZLE2(getByte)
+PUZZLE1(isNegative)
+PUZZLE2(fitsBits)
+PUZZLE1(negate)
+PUZZLE1(float_neg)
+PUZZLE2(divpwr2)
+PUZZLE2(logicalShift)
+PUZZLE2(isLessOrEqual)
+PUZZLE1(bitCount)
+PUZZLE1(howManyBits)
+PUZZLE1(bang)
+PUZZLE1(ilog2)
+PUZZLE1(float_i2f)
+
+/* Puzzles without arguments are tested once and need no entry */
+batch_rec batch_set[] = {
+    ENTRY(isZero),
+    ENTRY(bitOr),
+    ENTRY(getByte),
+    ENTRY(isNegative),
+    ENTRY(fitsBits),
+    ENTRY(negate),
+    ENTRY(float_neg),
+    ENTRY(divpwr2),
+    ENTRY(logicalShift),
+    ENTRY(isLessOrEqual),
+    ENTRY(bitCount),
+    ENTRY(howManyBits),
+    ENTRY(bang),
+    ENTRY(ilog2),
+    ENTRY(float_i2f),
+    {NULL, NULL, NULL}
+};
+
+/*
+ * find_batch - Find the batch entry for a function, or NULL
+ */
+batch_ptr find_batch(char *name)
+{
+    int i;
+
+    for (i = 0; batch_set[i].name; i++)
+	if (strcmp(batch_set[i].name, name) == 0)
+	    return &batch_set[i];
+    return NULL;
+}
@@ -0,0 +1,26 @@
+/*
+ * CS:APP Data Lab
+ *
+ * batch.h - Batched evaluation of the puzzle functions for btest.
+ *
+ * Each entry of batch_set evaluates a puzzle and its reference over
+ * whole arrays of arguments, in loops where the call is inlined. The
+ * test_rec table in btest.h is unchanged; btest looks puzzles up here
+ * by name and falls back to scalar calls for any that are missing.
+ */
+
+/* Evaluate a function on n argument tuples (args[0][i], args[1][i],
+   args[2][i]), storing the results in r, which must not overlap them.
+   Unused args are ignored. */
+typedef void (*batch_t)(int *args[3], int *restrict r, int n);
+
+typedef struct {
+    char *name;             /* String name, as in test_set */
+    batch_t solution_batch; /* Batched solution */
+    batch_t test_batch;     /* Batched reference */
+} batch_rec, *batch_ptr;
+
+extern batch_rec batch_set[];
+
+/* Find the batch entry for a function, or NULL */
+batch_ptr find_batch(char *name);
@@ -0,0 +1,206 @@
+/*
+ * CS:APP Data Lab
+ *
+ * bench.c - Cycle counts for the puzzle functions. See bench.h.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "btest.h"
+#include "batch.h"
+#include "bench.h"
+
+/* perf_event counter, or -1 */
+static int perf_fd = -1;
+
+/* Zero, but unknown to the compiler, so that r & zero still makes the
+   next argument wait for the result r */
+static volatile int zero = 0;
+
+/* Keeps the results of the timed loops alive */
+static volatile int sink;
+
+/* Functions that just return their first argument, for the baseline */
+static int ident0(void) { return 0; }
+static int ident1(int x) { return x; }
+static int ident2(int x, int y) { return x; }
+static int ident3(int x, int y, int z) { return x; }
+
+static void ident_batch(int *args[3], int *restrict r, int n)
+{
+    memcpy(r, args[0], n * sizeof(int));
+}
+
+static funct_t ident[4] = {
+    ident0, (funct_t) ident1, (funct_t) ident2, (funct_t) ident3
+};
+
+/*
+ * bench_init - Pick the counter. Return a description of its unit
+ */
+char *bench_init(void)
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (perf_fd >= 0)
+	return "cycles (perf_event)";
+#endif
+#if defined(__i386__) || defined(__x86_64__)
+    return "reference cycles (rdtsc)";
+#else
+    return "nanoseconds";
+#endif
+}
+
+/*
+ * read_counter - Current value of the counter
+ */
+static unsigned long long read_counter(void)
+{
+    if (perf_fd >= 0) {
+	unsigned long long c;
+	if (read(perf_fd, &c, sizeof(c)) == sizeof(c))
+	    return c;
+    }
+#if defined(__i386__) || defined(__x86_64__)
+    return __builtin_ia32_rdtsc();
+#else
+    {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+#endif
+}
+
+/*
+ * time_chain - Count n calls of f, each taking the previous result
+ * into its first argument
+ */
+static __attribute__((noinline)) unsigned long long
+time_chain(funct_t f, int args, int *vals[3], int n)
+{
+    int mask = zero;
+    int r = 0;
+    int i;
+    unsigned long long start = read_counter();
+
+    switch (args) {
+    case 0:
+	for (i = 0; i < n; i++)
+	    r += f();
+	break;
+    case 1:
+	for (i = 0; i < n; i++)
+	    r = ((funct1_t) f)(vals[0][i] + (r & mask));
+	break;
+    case 2:
+	for (i = 0; i < n; i++)
+	    r = ((funct2_t) f)(vals[0][i] + (r & mask), vals[1][i]);
+	break;
+    default:
+	for (i = 0; i < n; i++)
+	    r = ((funct3_t) f)(vals[0][i] + (r & mask), vals[1][i], vals[2][i]);
+	break;
+    }
+    start = read_counter() - start;
+    sink = r;
+    return start;
+}
+
+/*
+ * time_spread - Count n independent calls of f, or one call of fb on
+ * the whole array if it is not NULL
+ */
+static __attribute__((noinline)) unsigned long long
+time_spread(funct_t f, batch_t fb, int args, int *vals[3], int *r, int n)
+{
+    int i;
+    unsigned long long start = read_counter();
+
+    if (fb)
+	fb(vals, r, n);
+    else {
+	switch (args) {
+	case 0:
+	    for (i = 0; i < n; i++)
+		r[i] = f();
+	    break;
+	case 1:
+	    for (i = 0; i < n; i++)
+		r[i] = ((funct1_t) f)(vals[0][i]);
+	    break;
+	case 2:
+	    for (i = 0; i < n; i++)
+		r[i] = ((funct2_t) f)(vals[0][i], vals[1][i]);
+	    break;
+	default:
+	    for (i = 0; i < n; i++)
+		r[i] = ((funct3_t) f)(vals[0][i], vals[1][i], vals[2][i]);
+	    break;
+	}
+    }
+    start = read_counter() - start;
+    sink = r[n - 1];
+    return start;
+}
+
+static int cmp_count(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *) a;
+    unsigned long long y = *(const unsigned long long *) b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * median_cost - Median count per call over BENCH_RUNS runs of either
+ * loop
+ */
+static double median_cost(funct_t f, batch_t fb, int args, int *vals[3],
+			  int *r, int n, int chained)
+{
+    unsigned long long counts[BENCH_RUNS];
+    int i;
+
+    for (i = -BENCH_WARMUP; i < BENCH_RUNS; i++) {
+	unsigned long long c = chained ? time_chain(f, args, vals, n)
+	    : time_spread(f, fb, args, vals, r, n);
+	if (i >= 0)
+	    counts[i] = c;
+    }
+    qsort(counts, BENCH_RUNS, sizeof(counts[0]), cmp_count);
+    return (double) counts[BENCH_RUNS / 2] / n;
+}
+
+/*
+ * bench_funct - Time f on n argument tuples. See bench.h
+ */
+void bench_funct(funct_t f, batch_t fb, int args, int *vals[3], int n,
+		 bench_rec *res)
+{
+    int *r = malloc(n * sizeof(int));
+
+    res->latency = median_cost(f, NULL, args, vals, r, n, 1)
+	- median_cost(ident[args], NULL, args, vals, r, n, 1);
+    res->throughput = median_cost(f, fb, args, vals, r, n, 0)
+	- median_cost(ident[args], fb ? ident_batch : NULL, args, vals, r, n, 0);
+    if (res->latency < 0)
+	res->latency = 0;
+    if (res->throughput < 0)
+	res->throughput = 0;
+    free(r);
+}
@@ -0,0 +1,29 @@
+/*
+ * CS:APP Data Lab
+ *
+ * bench.h - Cycle counts for the puzzle functions (btest -b).
+ *
+ * Counts come from the CPU cycle counter through perf_event where the
+ * kernel allows it, else from the time stamp counter (reference
+ * cycles), else from the monotonic clock in nanoseconds. Each figure
+ * is the median of BENCH_RUNS timed runs, after BENCH_WARMUP untimed
+ * ones, less the same measurement of a function that just returns its
+ * first argument. Include after btest.h and batch.h.
+ */
+
+#define BENCH_WARMUP 3
+#define BENCH_RUNS 15
+
+typedef struct {
+    double latency;    /* per call, each call waiting on the last result */
+    double throughput; /* per call, calls independent of each other */
+} bench_rec;
+
+/* Pick the counter. Return a description of its unit */
+char *bench_init(void);
+
+/* Time f on the n argument tuples (vals[0][i], vals[1][i],
+   vals[2][i]). Throughput is timed on fb, its batched version, if
+   not NULL */
+void bench_funct(funct_t f, batch_t fb, int args, int *vals[3], int n,
+		 bench_rec *res);
@@ -0,0 +1,259 @@
+/*
+ * CS:APP Data Lab
+ *
+ * bitops.c - Array versions of the bit puzzles. See bitops.h.
+ *
+ * The portable kernels are straight-line C of the kind the puzzles
+ * ask for, which the compiler is free to vectorize. The AVX2 ones do
+ * eight ints at a time and leave the last n % 8 to the portable ones.
+ */
+#include <string.h>
+#include "bitops.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_AVX2 1
+#else
+#define HAVE_AVX2 0
+#endif
+
+typedef struct {
+    char *name;
+    void (*popcount)(const int *x, int *r, int n);
+    void (*bitlen)(const int *x, int *r, int n);
+    void (*ilog2)(const int *x, int *r, int n);
+    void (*fits)(const int *x, int bits, int *r, int n);
+    void (*i2f)(const int *x, unsigned *r, int n);
+} bitops_impl;
+
+/*****************
+ * Portable kernels
+ *****************/
+
+/* Ones in u, adding up bits in pairs, then nibbles, then bytes */
+static int ones(unsigned u)
+{
+    u = u - ((u >> 1) & 0x55555555);
+    u = (u & 0x33333333) + ((u >> 2) & 0x33333333);
+    u = (u + (u >> 4)) & 0x0f0f0f0f;
+    return (u * 0x01010101) >> 24;
+}
+
+/* Index of the highest one in u, or -1 if there is none */
+static int top(unsigned u)
+{
+    u |= u >> 1;
+    u |= u >> 2;
+    u |= u >> 4;
+    u |= u >> 8;
+    u |= u >> 16;
+    return ones(u) - 1;
+}
+
+static void popcount_c(const int *x, int *r, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+	r[i] = ones(x[i]);
+}
+
+static void bitlen_c(const int *x, int *r, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+	r[i] = top(x[i] ^ (x[i] >> 31)) + 2;
+}
+
+static void ilog2_c(const int *x, int *r, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+	r[i] = top(x[i]);
+}
+
+static void fits_c(const int *x, int bits, int *r, int n)
+{
+    int s = 32 - bits;
+    int i;
+    for (i = 0; i < n; i++)
+	r[i] = ((int) ((unsigned) x[i] << s) >> s) == x[i];
+}
+
+static void i2f_c(const int *x, unsigned *r, int n)
+{
+    int i;
+    for (i = 0; i < n; i++) {
+	float f = x[i];
+	memcpy(&r[i], &f, sizeof(f));
+    }
+}
+
+static bitops_impl portable = {
+    "portable", popcount_c, bitlen_c, ilog2_c, fits_c, i2f_c
+};
+
+/*************
+ * AVX2 kernels
+ *************/
+
+#if HAVE_AVX2
+#define AVX2 __attribute__((target("avx2")))
+
+/* Ones in each int: look up the count of each nibble with pshufb,
+   then add up the bytes of each int in pairs */
+AVX2 static void popcount_avx2(const int *x, int *r, int n)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+					 1, 2, 2, 3, 2, 3, 3, 4,
+					 0, 1, 1, 2, 1, 2, 2, 3,
+					 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i ones8 = _mm256_set1_epi8(1);
+    const __m256i ones16 = _mm256_set1_epi16(1);
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m256i v = _mm256_loadu_si256((const __m256i *) (x + i));
+	__m256i lo = _mm256_and_si256(v, nibble);
+	__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+	__m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo),
+				    _mm256_shuffle_epi8(lut, hi));
+	c = _mm256_madd_epi16(_mm256_maddubs_epi16(c, ones8), ones16);
+	_mm256_storeu_si256((__m256i *) (r + i), c);
+    }
+    popcount_c(x + i, r + i, n - i);
+}
+
+/* Index of the highest one in each int below 2^31, or -1 for 0, from
+   the exponent of its conversion to float. Clearing each one that has
+   a one above it leaves too few ones below the top for the conversion
+   to round up into the next power of two */
+AVX2 static __m256i top_avx2(__m256i v)
+{
+    __m256i e;
+
+    v = _mm256_andnot_si256(_mm256_srli_epi32(v, 1), v);
+    e = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(v)), 23);
+    return _mm256_max_epi32(_mm256_sub_epi32(e, _mm256_set1_epi32(127)),
+			    _mm256_set1_epi32(-1));
+}
+
+AVX2 static void bitlen_avx2(const int *x, int *r, int n)
+{
+    const __m256i two = _mm256_set1_epi32(2);
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m256i v = _mm256_loadu_si256((const __m256i *) (x + i));
+	v = _mm256_xor_si256(v, _mm256_srai_epi32(v, 31));
+	_mm256_storeu_si256((__m256i *) (r + i),
+			    _mm256_add_epi32(top_avx2(v), two));
+    }
+    bitlen_c(x + i, r + i, n - i);
+}
+
+/* As top_avx2, with 31 blended in where the sign bit is set */
+AVX2 static void ilog2_avx2(const int *x, int *r, int n)
+{
+    const __m256 neg = _mm256_castsi256_ps(_mm256_set1_epi32(31));
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m256i v = _mm256_loadu_si256((const __m256i *) (x + i));
+	__m256 t = _mm256_castsi256_ps(top_avx2(v));
+	t = _mm256_blendv_ps(t, neg, _mm256_castsi256_ps(v));
+	_mm256_storeu_si256((__m256i *) (r + i), _mm256_castps_si256(t));
+    }
+    ilog2_c(x + i, r + i, n - i);
+}
+
+/* Whether sign extending the low bits gives back the int */
+AVX2 static void fits_avx2(const int *x, int bits, int *r, int n)
+{
+    const __m128i s = _mm_cvtsi32_si128(32 - bits);
+    const __m256i one = _mm256_set1_epi32(1);
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m256i v = _mm256_loadu_si256((const __m256i *) (x + i));
+	__m256i w = _mm256_sra_epi32(_mm256_sll_epi32(v, s), s);
+	_mm256_storeu_si256((__m256i *) (r + i),
+			    _mm256_and_si256(_mm256_cmpeq_epi32(v, w), one));
+    }
+    fits_c(x + i, bits, r + i, n - i);
+}
+
+/* vcvtdq2ps rounds as the current mode says, which is to nearest
+   even unless the program has changed it, as does (float) x */
+AVX2 static void i2f_avx2(const int *x, unsigned *r, int n)
+{
+    int i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	__m256i v = _mm256_loadu_si256((const __m256i *) (x + i));
+	_mm256_storeu_si256((__m256i *) (r + i),
+			    _mm256_castps_si256(_mm256_cvtepi32_ps(v)));
+    }
+    i2f_c(x + i, r + i, n - i);
+}
+
+static bitops_impl avx2 = {
+    "avx2", popcount_avx2, bitlen_avx2, ilog2_avx2, fits_avx2, i2f_avx2
+};
+#endif
+
+/******************
+ * Dispatch
+ ******************/
+
+/* The kernels in use, or NULL until the first call */
+static bitops_impl *impl = NULL;
+
+/*
+ * bitops_init - Choose the kernels. See bitops.h
+ */
+char *bitops_init(int simd)
+{
+    impl = &portable;
+#if HAVE_AVX2
+    __builtin_cpu_init();
+    if (simd && __builtin_cpu_supports("avx2"))
+	impl = &avx2;
+#endif
+    return impl->name;
+}
+
+void bitops_popcount(const int *x, int *r, int n)
+{
+    if (!impl)
+	bitops_init(1);
+    impl->popcount(x, r, n);
+}
+
+void bitops_bitlen(const int *x, int *r, int n)
+{
+    if (!impl)
+	bitops_init(1);
+    impl->bitlen(x, r, n);
+}
+
+void bitops_ilog2(const int *x, int *r, int n)
+{
+    if (!impl)
+	bitops_init(1);
+    impl->ilog2(x, r, n);
+}
+
+void bitops_fits(const int *x, int bits, int *r, int n)
+{
+    if (!impl)
+	bitops_init(1);
+    impl->fits(x, bits, r, n);
+}
+
+void bitops_i2f(const int *x, unsigned *r, int n)
+{
+    if (!impl)
+	bitops_init(1);
+    impl->i2f(x, r, n);
+}
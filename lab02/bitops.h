@@ -0,0 +1,36 @@
+/*
+ * CS:APP Data Lab
+ *
+ * bitops.h - Array versions of the bit puzzles, for use outside the
+ * lab.
+ *
+ * Each kernel computes one puzzle over n ints, with the results
+ * defined by the reference in tests.c (btest -k checks them against
+ * it). There is a portable C implementation and, on x86, an AVX2 one;
+ * the first call picks the AVX2 one if the CPU has it, unless
+ * bitops_init() has already chosen. The kernels take any alignment
+ * and length, and x and r may be the same array.
+ */
+
+/* Use the AVX2 kernels if simd is set and the CPU supports them, the
+   portable ones otherwise. Return the name of the ones in use */
+char *bitops_init(int simd);
+
+/* r[i] = bitCount(x[i]): the number of ones */
+void bitops_popcount(const int *x, int *r, int n);
+
+/* r[i] = howManyBits(x[i]): the fewest bits that hold x[i] in two's
+   complement */
+void bitops_bitlen(const int *x, int *r, int n);
+
+/* r[i] = ilog2(x[i]): the index of the highest one, so 31 for
+   negative x[i], and -1 for 0 */
+void bitops_ilog2(const int *x, int *r, int n);
+
+/* r[i] = fitsBits(x[i], bits): whether x[i] lies in the range of a
+   bits-bit two's complement number, for 1 <= bits <= 32 */
+void bitops_fits(const int *x, int bits, int *r, int n);
+
+/* r[i] = float_i2f(x[i]): the bits of (float) x[i], rounded to
+   nearest even */
+void bitops_i2f(const int *x, unsigned *r, int n);
@@ -21,7 +21,15 @@
 #include <signal.h>
 #include <setjmp.h>
 #include <math.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/stat.h>
 #include "btest.h"
+#include "batch.h"
+#include "bench.h"
+#include "fuzz.h"
+#include "reload.h"
+#include "bitops.h"
 
 /* Not declared in some stdlib.h files, so define here */
 float strtof(const char *nptr, char **endptr);
@@ -34,6 +42,9 @@ float strtof(const char *nptr, char **endptr);
    seconds */
 #define TIMEOUT_LIMIT 10
 
+/* Default limit with -e, where one function makes up to 2^33 calls */
+#define EXHAUSTIVE_TIMEOUT_LIMIT 600
+
 /* For functions with a single argument, generate TEST_RANGE values
    above and below the min and max test values, and above and below
    zero. Functions with two or three args will use square and cube
@@ -43,9 +54,38 @@ float strtof(const char *nptr, char **endptr);
 
 /* This defines the maximum size of any test value array. The
    gen_vals() routine creates k test values for each value of
-   TEST_RANGE, thus MAX_TEST_VALS must be at least k*TEST_RANGE */
+   TEST_RANGE, thus MAX_TEST_VALS must be at least k*TEST_RANGE. For
+   floating point puzzles, k is 12 and the per-exponent values below
+   add 512*FRAC_SAMPLES */
 #define MAX_TEST_VALS 13*TEST_RANGE
 
+/* For floating point puzzles, also test every sign and exponent with
+   FRAC_EDGE fractions at each end of the binade, the 69 fractions
+   made of a single bit or a run of ones at either end, and one random
+   fraction in each of FRAC_STRATA equal slices */
+#define FRAC_EDGE 16
+#define FRAC_STRATA 64
+#define FRAC_SAMPLES (2*FRAC_EDGE + 69 + FRAC_STRATA)
+
+/* Workers claim the argument cross product in blocks of this many
+   consecutive test cases, which are also the unit of batched
+   evaluation */
+#define BLOCK_SIZE 4096
+
+/* With -w, how often to look for changes to bits.c, in ms */
+#define WATCH_INTERVAL 20
+
+/* Longest line read from dlc */
+#define MAXLINE 1024
+
+/* With -k, check the bitops kernels on the KERNEL_WINDOW values next
+   to 0, Tmin and Tmax, the values within KERNEL_NEAR of each power of
+   two, and KERNEL_RANDOM random ones */
+#define KERNEL_WINDOW 65536
+#define KERNEL_NEAR 64
+#define KERNEL_RANDOM (1 << 20)
+#define KERNEL_VALS (4*KERNEL_WINDOW + 32*2*KERNEL_NEAR + KERNEL_RANDOM)
+
 /**********************************
  * Globals defined in other modules 
  **********************************/
@@ -74,6 +114,26 @@ static unsigned argval[3] = {0,0,0};
 /* Use fixed weight for rating, and if so, what should it  be? (-r) */
 static int global_rating = 0;
 
+/* Number of threads to split each function's tests across (-j) */
+static int num_workers = 1;
+
+/* Test one-argument functions on every possible argument (-e) */
+static int exhaustive = 0;
+
+/* Count cycles per call instead of testing (-b) */
+static int bench = 0;
+
+/* After the regular tests pass, fuzz each function for this many
+   seconds (-z), starting from this seed (-s) */
+static int fuzz_secs = 0;
+static unsigned long long fuzz_seed = 0;
+
+/* Rerun the tests whenever bits.c changes (-w) */
+static int watch = 0;
+
+/* Check the bitops kernels instead of bits.c (-k) */
+static int kernels = 0;
+
 /******************
  * Helper functions
  ******************/
@@ -97,9 +157,10 @@ handler_t *Signal(int signum, handler_t *handler)
 }
 
 /* 
- * timeout_handler - SIGALARM hander 
+ * timeout_handler - SIGALARM hander. Each thread has its own envbuf,
+ * so a worker that is sent SIGALRM jumps back into its own loop.
  */
-sigjmp_buf envbuf;
+__thread sigjmp_buf envbuf;
 void timeout_handler(int sig) {
     siglongjmp(envbuf, 1);
 }
@@ -136,7 +197,8 @@ static int gen_vals(int test_vals[], int min, int max, int test_range, int arg)
      * representation of a float. For this case we want to test the
      * regions around zero, the smallest normalized and largest
      * denormalized numbers, one, and the largest normalized number,
-     * as well as inf and nan.
+     * as well as inf and nan, followed by samples of the fractions of
+     * every sign and exponent.
      */
     if ((min == 1 && max == 1)) { 
 	unsigned smallest_norm = 0x00800000;
@@ -146,6 +208,8 @@ static int gen_vals(int test_vals[], int min, int max, int test_range, int arg)
 	unsigned inf = 0x7f800000;
 	unsigned nan =  0x7fc00000;
 	unsigned sign = 0x80000000;
+	unsigned frac_mask = 0x007fffff;
+	unsigned e;
 
 	/* Test range should be at most 1/2 the range of one exponent
 	   value */
@@ -186,6 +250,24 @@ static int gen_vals(int test_vals[], int min, int max, int test_range, int arg)
 	test_vals[test_count++] = nan;        /* nan */
 	test_vals[test_count++] = sign | nan; /* -nan */
 
+	/* Every sign and exponent */
+	for (e = 0; e < 512; e++) {
+	    unsigned base = e << 23;
+	    unsigned slice = (frac_mask + 1) / FRAC_STRATA;
+
+	    for (i = 0; i < FRAC_EDGE; i++) {
+		test_vals[test_count++] = base | i;
+		test_vals[test_count++] = base | (frac_mask - i);
+	    }
+	    for (i = 0; i < 23; i++) {
+		test_vals[test_count++] = base | (1u << i);
+		test_vals[test_count++] = base | (frac_mask >> i);
+		test_vals[test_count++] = base | (frac_mask & (frac_mask << i));
+	    }
+	    for (i = 0; i < FRAC_STRATA; i++)
+		test_vals[test_count++] = base | (i * slice + rand() % slice);
+	}
+
 	return test_count;
     }
 
@@ -290,6 +372,340 @@ static int test_3_arg(funct_t f, funct_t ft,
     return error;
 }
 
+/* 
+ * check_case - Test case number idx of the argument cross product,
+ * numbered in the order the serial loops visit them. Only print the
+ * error message if verbose is set. Return 1 on error.
+ */
+static int check_case(test_ptr t, int *vals[3], int counts[3],
+		      long long idx, int verbose)
+{
+    int a[3] = {0, 0, 0};
+    int i, r, rt;
+
+    for (i = t->args - 1; i >= 0; i--) {
+	a[i] = vals[i][idx % counts[i]];
+	idx /= counts[i];
+    }
+
+    if (verbose) {
+	switch (t->args) {
+	case 1:
+	    return test_1_arg(t->solution_funct, t->test_funct, a[0], t->name);
+	case 2:
+	    return test_2_arg(t->solution_funct, t->test_funct, a[0], a[1], t->name);
+	default:
+	    return test_3_arg(t->solution_funct, t->test_funct, a[0], a[1], a[2], t->name);
+	}
+    }
+
+    switch (t->args) {
+    case 1:
+	r = ((funct1_t) t->solution_funct)(a[0]);
+	rt = ((funct1_t) t->test_funct)(a[0]);
+	break;
+    case 2:
+	r = ((funct2_t) t->solution_funct)(a[0], a[1]);
+	rt = ((funct2_t) t->test_funct)(a[0], a[1]);
+	break;
+    default:
+	r = ((funct3_t) t->solution_funct)(a[0], a[1], a[2]);
+	rt = ((funct3_t) t->test_funct)(a[0], a[1], a[2]);
+	break;
+    }
+    return r != rt;
+}
+
+/* State shared by the workers testing one function */
+typedef struct {
+    test_ptr t;
+    batch_ptr batch;        /* batched versions of t's functions, or NULL */
+    int exhaustive;         /* case i is the single argument base + i */
+    int base;
+    int *vals[3];           /* otherwise cases index the cross product */
+    int counts[3];
+    long long total;        /* number of cases */
+    long long next;         /* first case of the next unclaimed block */
+    long long first_error;  /* lowest failing case found so far */
+    int running;            /* workers that have not finished */
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+} par_test_t;
+
+typedef struct {
+    par_test_t *p;
+    pthread_t tid;
+    int finished;
+} worker_t;
+
+/* 
+ * first_mismatch - Compare the n results of the solution and the
+ * reference with one memcmp. Return the index of the first
+ * difference, or -1 
+ */
+static int first_mismatch(int *r, int *rt, int n)
+{
+    int i;
+
+    if (memcmp(r, rt, n * sizeof(int)) == 0)
+	return -1;
+    for (i = 0; r[i] == rt[i]; i++)
+	;
+    return i;
+}
+
+/* 
+ * check_block - Test cases start to end-1. With a batch entry, gather
+ * the argument tuples into arrays and run the solution and reference
+ * over the whole block; otherwise test one case at a time. Return the
+ * first failing case, or -1 
+ */
+static long long check_block(par_test_t *p, long long start, long long end)
+{
+    int a[3][BLOCK_SIZE];
+    int *args[3] = {a[0], a[1], a[2]};
+    int r[BLOCK_SIZE], rt[BLOCK_SIZE];
+    int k[3] = {0, 0, 0};
+    int nargs = p->t->args;
+    int n = end - start;
+    long long idx = start;
+    int i, j;
+
+    if (!p->batch) {
+	for (idx = start; idx < end; idx++)
+	    if (check_case(p->t, p->vals, p->counts, idx, 0))
+		return idx;
+	return -1;
+    }
+
+    /* Position of case start in the cross product, then step through
+       it like the serial loops, last argument fastest */
+    for (j = nargs - 1; j >= 0; j--) {
+	k[j] = idx % p->counts[j];
+	idx /= p->counts[j];
+    }
+    for (i = 0; i < n; i++) {
+	for (j = 0; j < nargs; j++)
+	    a[j][i] = p->vals[j][k[j]];
+	for (j = nargs - 1; j >= 0 && ++k[j] == p->counts[j]; j--)
+	    k[j] = 0;
+    }
+
+    p->batch->solution_batch(args, r, n);
+    p->batch->test_batch(args, rt, n);
+    i = first_mismatch(r, rt, n);
+    return i < 0 ? -1 : start + i;
+}
+
+/* 
+ * check_batch - Test a block of consecutive single arguments: run the
+ * solution over the whole block, then the reference, then compare the
+ * two result arrays. Return the first failing case, or -1 
+ */
+static long long check_batch(par_test_t *p, long long start, long long end)
+{
+    unsigned x = (unsigned) p->base + (unsigned) start;
+    int n = end - start;
+    int a[BLOCK_SIZE];
+    int *args[3] = {a, a, a};
+    int r[BLOCK_SIZE], rt[BLOCK_SIZE];
+    int i;
+
+    for (i = 0; i < n; i++)
+	a[i] = (int) (x + i);
+    if (p->batch) {
+	p->batch->solution_batch(args, r, n);
+	p->batch->test_batch(args, rt, n);
+    } else {
+	funct1_t f = (funct1_t) p->t->solution_funct;
+	funct1_t ft = (funct1_t) p->t->test_funct;
+
+	for (i = 0; i < n; i++)
+	    r[i] = f(a[i]);
+	for (i = 0; i < n; i++)
+	    rt[i] = ft(a[i]);
+    }
+    i = first_mismatch(r, rt, n);
+    return i < 0 ? -1 : start + i;
+}
+
+/* 
+ * test_worker - Claim blocks of test cases in increasing order until
+ * they run out or start past the first known error. SIGALRM from the
+ * main thread ends the worker early.
+ */
+static void *test_worker(void *arg)
+{
+    worker_t *w = arg;
+    par_test_t *p = w->p;
+    sigset_t alarm_set;
+
+    sigemptyset(&alarm_set);
+    sigaddset(&alarm_set, SIGALRM);
+
+    if (sigsetjmp(envbuf, 1) == 0) {
+	pthread_sigmask(SIG_UNBLOCK, &alarm_set, NULL);
+	for (;;) {
+	    long long start = __atomic_fetch_add(&p->next, BLOCK_SIZE, __ATOMIC_RELAXED);
+	    long long end = start + BLOCK_SIZE;
+	    long long bad;
+
+	    if (start >= p->total || 
+		start >= __atomic_load_n(&p->first_error, __ATOMIC_RELAXED))
+		break;
+	    if (end > p->total)
+		end = p->total;
+
+	    bad = p->exhaustive ? check_batch(p, start, end) : check_block(p, start, end);
+	    if (bad >= 0) {
+		/* keep the lowest failing case */
+		long long seen = __atomic_load_n(&p->first_error, __ATOMIC_RELAXED);
+		while (bad < seen && 
+		       !__atomic_compare_exchange_n(&p->first_error, &seen, bad, 0,
+						    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		    ;
+	    }
+	}
+    }
+
+    /* No more jumps once the main thread may consider us finished */
+    pthread_sigmask(SIG_BLOCK, &alarm_set, NULL);
+    pthread_mutex_lock(&p->lock);
+    w->finished = 1;
+    p->running--;
+    pthread_cond_signal(&p->done);
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/* 
+ * run_workers - Run num_workers test_workers on p->total cases and
+ * wait for them, for at most timeout_limit seconds. Return 1 on a
+ * timeout 
+ */
+static int run_workers(par_test_t *p)
+{
+    worker_t workers[num_workers];
+    struct timeval now;
+    struct timespec deadline;
+    sigset_t alarm_set, old_set;
+    int i, rc = 0, timed_out;
+
+    p->next = 0;
+    p->first_error = p->total;
+    p->running = num_workers;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    /* Workers start with SIGALRM blocked and unblock it once their
+       envbuf is set */
+    sigemptyset(&alarm_set);
+    sigaddset(&alarm_set, SIGALRM);
+    pthread_sigmask(SIG_BLOCK, &alarm_set, &old_set);
+    for (i = 0; i < num_workers; i++) {
+	workers[i].p = p;
+	workers[i].finished = 0;
+	pthread_create(&workers[i].tid, NULL, test_worker, &workers[i]);
+    }
+
+    gettimeofday(&now, NULL);
+    deadline.tv_sec = now.tv_sec + timeout_limit;
+    deadline.tv_nsec = now.tv_usec * 1000;
+
+    pthread_mutex_lock(&p->lock);
+    while (p->running > 0 && rc == 0) {
+	if (timeout_limit > 0)
+	    rc = pthread_cond_timedwait(&p->done, &p->lock, &deadline);
+	else
+	    pthread_cond_wait(&p->done, &p->lock);
+    }
+    /* The wait can time out just as the last worker finishes, so only
+       workers still running mean a timeout */
+    timed_out = p->running > 0;
+    if (timed_out) {
+	/* Knock every unfinished worker out of its loop */
+	for (i = 0; i < num_workers; i++)
+	    if (!workers[i].finished)
+		pthread_kill(workers[i].tid, SIGALRM);
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    for (i = 0; i < num_workers; i++)
+	pthread_join(workers[i].tid, NULL);
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->done);
+
+    if (timed_out) {
+	printf("ERROR: Test %s failed.\n  Timed out after %d secs (probably infinite loop)\n", p->t->name, timeout_limit);
+	return 1;
+    }
+    return 0;
+}
+
+/* 
+ * test_parallel - Test a function with arguments on num_workers
+ * threads. Reports the same first failing case as the serial loops.
+ * Return number of errors 
+ */
+static int test_parallel(test_ptr t, int *vals[3], int counts[3])
+{
+    par_test_t p;
+    int i;
+
+    p.t = t;
+    p.batch = find_batch(t->name);
+    p.exhaustive = 0;
+    p.total = 1;
+    for (i = 0; i < t->args; i++) {
+	p.vals[i] = vals[i];
+	p.counts[i] = counts[i];
+	p.total *= counts[i];
+    }
+
+    if (run_workers(&p))
+	return 1;
+    if (p.first_error < p.total) {
+	/* Rerun the failing case here to print it */
+	check_case(t, vals, counts, p.first_error, 1);
+	return 1;
+    }
+    return 0;
+}
+
+/* 
+ * test_exhaustive - Test a one-argument function on every argument in
+ * its range: all 2^32 bit patterns for floating point puzzles. Reports
+ * the lowest failing argument. Return number of errors 
+ */
+static int test_exhaustive(test_ptr t)
+{
+    par_test_t p;
+    int min = t->arg_ranges[0][0];
+    int max = t->arg_ranges[0][1];
+
+    p.t = t;
+    p.batch = find_batch(t->name);
+    p.exhaustive = 1;
+    if (min == 1 && max == 1) {
+	/* f.p. puzzle: the argument is the bits of a float */
+	p.base = 0;
+	p.total = 1LL << 32;
+    } else {
+	p.base = min;
+	p.total = (long long) max - min + 1;
+    }
+
+    if (run_workers(&p))
+	return 1;
+    if (p.first_error < p.total) {
+	test_1_arg(t->solution_funct, t->test_funct,
+		   (int) ((unsigned) p.base + (unsigned) p.first_error), t->name);
+	return 1;
+    }
+    return 0;
+}
+
 /* 
  * test_function - Test a function.  Return number of errors 
  */
@@ -311,6 +727,10 @@ static int test_function(test_ptr t) {
 	exit(1);
     }
 
+    /* Exhaustive mode replaces sampling for one-argument functions */
+    if (exhaustive && args == 1 && !has_arg[0])
+	return test_exhaustive(t);
+
     /* Assign range of argument test vals so as to conserve the total
        number of tests, independent of the number of arguments */
     if (args == 1) {
@@ -344,6 +764,13 @@ static int test_function(test_ptr t) {
 
     }
 
+    /* Split the cross product of test values across threads, and
+       evaluate it in blocks when the function has a batch entry */
+    if (args > 0 && (num_workers > 1 || find_batch(t->name))) {
+	int *vals[3] = {arg_test_vals[0], arg_test_vals[1], arg_test_vals[2]};
+	return test_parallel(t, vals, test_counts);
+    }
+
     /* Handle timeouts in the test code */
     if (timeout_limit > 0) {
 	int rc;
@@ -418,6 +845,83 @@ static int test_function(test_ptr t) {
     return errors;
 }
 
+/* 
+ * fuzz_function - Fuzz a function that passed its regular tests.
+ * Return number of errors
+ */
+static int fuzz_function(test_ptr t)
+{
+    int ranges[3][2];
+    fuzz_rec res;
+    int i, failed;
+
+    for (i = 0; i < t->args; i++) {
+	int min = t->arg_ranges[i][0];
+	int max = t->arg_ranges[i][1];
+
+	if (has_arg[i]) {
+	    ranges[i][0] = argval[i];
+	    ranges[i][1] = argval[i];
+	} else if (min == 1 && max == 1) {
+	    /* f.p. puzzle: any bit pattern */
+	    ranges[i][0] = INT_MIN;
+	    ranges[i][1] = INT_MAX;
+	} else {
+	    ranges[i][0] = min;
+	    ranges[i][1] = max;
+	}
+    }
+
+    if (timeout_limit > 0) {
+	if (sigsetjmp(envbuf, 1)) {
+	    printf("ERROR: Test %s failed.\n  Timed out after %d secs (probably infinite loop)\n", t->name, timeout_limit);
+	    return 1;
+	}
+	alarm(fuzz_secs + timeout_limit);
+    }
+    failed = fuzz_funct(t, ranges, fuzz_secs, fuzz_seed, &res);
+    alarm(0);
+
+    if (!grade)
+	printf("Fuzzed %s: %lld cases, %d kept, %d edges (seed %llu)\n",
+	       t->name, res.cases, res.corpus, res.edges, fuzz_seed);
+    if (failed) {
+	switch (t->args) {
+	case 1:
+	    test_1_arg(t->solution_funct, t->test_funct, res.args[0], t->name);
+	    break;
+	case 2:
+	    test_2_arg(t->solution_funct, t->test_funct, res.args[0], res.args[1], t->name);
+	    break;
+	default:
+	    test_3_arg(t->solution_funct, t->test_funct,
+		       res.args[0], res.args[1], res.args[2], t->name);
+	    break;
+	}
+	return 1;
+    }
+    return 0;
+}
+
+/* 
+ * run_test - Test (and fuzz) one function and print its score line.
+ * Return number of errors 
+ */ 
+static int run_test(test_ptr t)
+{
+    int rating = global_rating ? global_rating : t->rating;
+    int terrors = test_function(t);
+
+    if (terrors == 0 && fuzz_secs > 0 && t->args > 0)
+	terrors = fuzz_function(t);
+    alarm(0);
+
+    if (grade || terrors < 1)
+	printf(" %.0f\t%d\t%d\t%s\n", 
+	       terrors == 0 ? (double) rating : 0.0, rating, terrors, t->name);
+    return terrors;
+}
+
 /* 
  * run_tests - Run series of tests.  Return number of errors 
  */ 
@@ -431,26 +935,337 @@ static int run_tests()
     printf("Score\tRating\tErrors\tFunction\n");
 
     for (i = 0; test_set[i].solution_funct; i++) {
-	int terrors;
-	double tscore;
-	double tpoints;
 	if (!test_fname || strcmp(test_set[i].name,test_fname) == 0) {
 	    int rating = global_rating ? global_rating : test_set[i].rating;
-	    terrors = test_function(&test_set[i]);
+	    int terrors = run_test(&test_set[i]);
+
 	    errors += terrors;
-	    tscore = terrors == 0 ? 1.0 : 0.0;
-	    tpoints = rating * tscore;
-	    points += tpoints;
+	    if (terrors == 0)
+		points += rating;
+	    max_points += rating;
+	}
+    }
+
+    printf("Total points: %.0f/%.0f\n", points, max_points);
+    return errors;
+}
+
+/* 
+ * watch_tests - Whenever bits.c changes, rebuild bits.so, load it in
+ * place of the current solutions, and rerun the tests of just the
+ * puzzles whose code changed. Never returns
+ */
+static int watch_tests()
+{
+    struct stat st;
+    struct timespec seen = {0, 0};
+    int *changed, *terrors;
+    int i, n;
+
+    for (n = 0; test_set[n].solution_funct; n++)
+	;
+    changed = calloc(n, sizeof(int));
+    terrors = malloc(n * sizeof(int));
+
+    for (;;) {
+	struct timeval start, end;
+	double points = 0.0;
+	double max_points = 0.0;
+	int num_changed = 0;
+
+	/* Wait for a change that has settled */
+	if (stat("bits.c", &st) < 0 || 
+	    (st.st_mtim.tv_sec == seen.tv_sec && st.st_mtim.tv_nsec == seen.tv_nsec)) {
+	    usleep(WATCH_INTERVAL * 1000);
+	    continue;
+	}
+	seen = st.st_mtim;
+	usleep(WATCH_INTERVAL * 1000);
+	if (stat("bits.c", &st) == 0 &&
+	    (st.st_mtim.tv_sec != seen.tv_sec || st.st_mtim.tv_nsec != seen.tv_nsec))
+	    continue;
+
+	gettimeofday(&start, NULL);
+	if (system("make -s bits.so") != 0 || reload_bits("bits.so", changed) < 0) {
+	    printf("Build failed. Waiting for bits.c to change\n");
+	    fflush(stdout);
+	    continue;
+	}
+	gettimeofday(&end, NULL);
+
+	for (i = 0; i < n; i++)
+	    if (changed[i] && (!test_fname || strcmp(test_set[i].name, test_fname) == 0))
+		num_changed++;
+	printf("Reloaded bits.c in %.0f ms: %d puzzle%s changed\n",
+	       (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_usec - start.tv_usec) / 1e3,
+	       num_changed, num_changed == 1 ? "" : "s");
+	if (num_changed > 0)
+	    printf("Score\tRating\tErrors\tFunction\n");
+
+	for (i = 0; i < n; i++) {
+	    int rating = global_rating ? global_rating : test_set[i].rating;
+
+	    if (test_fname && strcmp(test_set[i].name, test_fname) != 0)
+		continue;
+	    if (changed[i])
+		terrors[i] = run_test(&test_set[i]);
+	    if (terrors[i] == 0)
+		points += rating;
 	    max_points += rating;
+	}
+	printf("Total points: %.0f/%.0f\n\n", points, max_points);
+	fflush(stdout);
+    }
+    return 0;
+}
 
-	    if (grade || terrors < 1)
-		printf(" %.0f\t%d\t%d\t%s\n", 
-		       tpoints, rating, terrors, test_set[i].name);
+/* 
+ * get_op_counts - Fill ops with the operator count of each function in
+ * test_set, as reported by "dlc -e", or -1 where there is none
+ */
+static void get_op_counts(int ops[])
+{
+    char line[MAXLINE];
+    FILE *fp;
+    int i;
+
+    for (i = 0; test_set[i].solution_funct; i++)
+	ops[i] = -1;
+
+    fp = popen("./dlc -e bits.c 2>/dev/null", "r");
+    if (!fp)
+	return;
+
+    /* Lines look like "dlc:bits.c:142:bitOr: 4 operators" */
+    while (fgets(line, MAXLINE, fp)) {
+	char *name, *count;
+	int n;
+
+	if (!strtok(line, ":") || !strtok(NULL, ":") || !strtok(NULL, ":"))
+	    continue;
+	name = strtok(NULL, ":");
+	count = strtok(NULL, ":");
+	if (!name || !count || sscanf(count, "%d operators", &n) != 1)
+	    continue;
+	for (i = 0; test_set[i].solution_funct; i++)
+	    if (strcmp(test_set[i].name, name) == 0)
+		ops[i] = n;
+    }
+    pclose(fp);
+}
 
+/* 
+ * bench_function - Time a function and its reference on BLOCK_SIZE
+ * random arguments. Return 1 on a timeout
+ */
+static int bench_function(test_ptr t, bench_rec *sol, bench_rec *ref)
+{
+    static int arg_vals[3][BLOCK_SIZE];
+    int *vals[3] = {arg_vals[0], arg_vals[1], arg_vals[2]};
+    batch_ptr b = find_batch(t->name);
+    int i, k;
+
+    for (i = 0; i < t->args; i++) {
+	int min = t->arg_ranges[i][0];
+	int max = t->arg_ranges[i][1];
+
+	for (k = 0; k < BLOCK_SIZE; k++) {
+	    if (has_arg[i])
+		arg_vals[i][k] = argval[i];
+	    else if (i == 0 && min == 1 && max == 1)
+		/* f.p. puzzle: any bit pattern */
+		arg_vals[i][k] = ((unsigned) rand() << 16) ^ (unsigned) rand();
+	    else
+		arg_vals[i][k] = random_val(min, max);
 	}
     }
 
-    printf("Total points: %.0f/%.0f\n", points, max_points);
+    if (timeout_limit > 0) {
+	if (sigsetjmp(envbuf, 1)) {
+	    printf("ERROR: Benchmark %s failed.\n  Timed out after %d secs (probably infinite loop)\n", t->name, timeout_limit);
+	    return 1;
+	}
+	alarm(timeout_limit);
+    }
+    bench_funct(t->solution_funct, b ? b->solution_batch : NULL,
+		t->args, vals, BLOCK_SIZE, sol);
+    bench_funct(t->test_funct, b ? b->test_batch : NULL,
+		t->args, vals, BLOCK_SIZE, ref);
+    alarm(0);
+    return 0;
+}
+
+/* 
+ * run_bench - Print the operator count, operator limit, and cost per
+ * call of each function next to its reference. Return number of
+ * timeouts
+ */
+static int run_bench()
+{
+    int *ops;
+    int i;
+    int errors = 0;
+
+    for (i = 0; test_set[i].solution_funct; i++)
+	;
+    ops = malloc(i * sizeof(int));
+    get_op_counts(ops);
+    printf("Median %s per call of %d runs\n", bench_init(), BENCH_RUNS);
+    printf("Ops\tLimit\tLat\tRefLat\tTput\tRefTput\tFunction\n");
+
+    for (i = 0; test_set[i].solution_funct; i++) {
+	bench_rec sol, ref;
+
+	if (test_fname && strcmp(test_set[i].name, test_fname) != 0)
+	    continue;
+	if (bench_function(&test_set[i], &sol, &ref)) {
+	    errors++;
+	    continue;
+	}
+	if (ops[i] >= 0)
+	    printf(" %d", ops[i]);
+	else
+	    printf(" -");
+	printf("\t%d\t%.1f\t%.1f\t%.1f\t%.1f\t%s\n", test_set[i].op_limit,
+	       sol.latency, ref.latency, sol.throughput, ref.throughput,
+	       test_set[i].name);
+    }
+    free(ops);
+    return errors;
+}
+
+/* The puzzles with bitops kernels, by their names in test_set */
+static char *kernel_names[] = {
+    "bitCount", "howManyBits", "ilog2", "fitsBits", "float_i2f", NULL
+};
+
+/* 
+ * run_kernel - Compute the puzzle name on x[0..n-1] (with second
+ * argument arg2) with its bitops kernel
+ */
+static void run_kernel(char *name, int *x, int arg2, int *r, int n)
+{
+    if (strcmp(name, "bitCount") == 0)
+	bitops_popcount(x, r, n);
+    else if (strcmp(name, "howManyBits") == 0)
+	bitops_bitlen(x, r, n);
+    else if (strcmp(name, "ilog2") == 0)
+	bitops_ilog2(x, r, n);
+    else if (strcmp(name, "fitsBits") == 0)
+	bitops_fits(x, arg2, r, n);
+    else
+	bitops_i2f(x, (unsigned *) r, n);
+}
+
+/* 
+ * kernel_vals - Generate the values to check the kernels on. Return
+ * how many there are
+ */
+static int kernel_vals(int vals[])
+{
+    int n = 0;
+    int i, b;
+
+    for (i = 0; i < KERNEL_WINDOW; i++) {
+	vals[n++] = i;
+	vals[n++] = -i - 1;
+	vals[n++] = INT_MIN + i;
+	vals[n++] = INT_MAX - i;
+    }
+    for (b = 0; b < 32; b++)
+	for (i = -KERNEL_NEAR; i < KERNEL_NEAR; i++)
+	    vals[n++] = (1u << b) + i;
+    for (i = 0; i < KERNEL_RANDOM; i++)
+	vals[n++] = ((unsigned) rand() << 16) ^ (unsigned) rand();
+    return n;
+}
+
+/* 
+ * check_kernel - Compare the bitops kernel for t with its reference
+ * on the values in vals that are in t's range, and every second
+ * argument in its range. The kernel runs on pieces of varying length
+ * and alignment, to cover its tail. Return 1 if they differ
+ */
+static int check_kernel(test_ptr t, int *vals, int n, int *x, int *r)
+{
+    int min = t->arg_ranges[0][0];
+    int max = t->arg_ranges[0][1];
+    int lo = 0, hi = 0;
+    int arg2, i, m, len, piece;
+
+    /* {1,1} marks a f.p. puzzle, which takes any bit pattern */
+    for (i = m = 0; i < n; i++)
+	if ((min == 1 && max == 1) || (vals[i] >= min && vals[i] <= max))
+	    x[m++] = vals[i];
+    if (t->args > 1) {
+	lo = t->arg_ranges[1][0];
+	hi = t->arg_ranges[1][1];
+    }
+
+    for (arg2 = lo; arg2 <= hi; arg2++) {
+	for (i = piece = 0; i < m; i += len, piece++) {
+	    len = 1 + (piece * 37) % BLOCK_SIZE;
+	    if (len > m - i)
+		len = m - i;
+	    run_kernel(t->name, x + i, arg2, r + i, len);
+	}
+	for (i = 0; i < m; i++) {
+	    int rt = t->args > 1 ?
+		((funct2_t) t->test_funct)(x[i], arg2) :
+		((funct1_t) t->test_funct)(x[i]);
+
+	    if (r[i] != rt) {
+		if (t->args > 1)
+		    printf("ERROR: Kernel %s(%d[0x%x],%d[0x%x]) failed...\n...Gives %d[0x%x]. Should be %d[0x%x]\n", t->name, x[i], x[i], arg2, arg2, r[i], r[i], rt, rt);
+		else
+		    printf("ERROR: Kernel %s(%d[0x%x]) failed...\n...Gives %d[0x%x]. Should be %d[0x%x]\n", t->name, x[i], x[i], r[i], r[i], rt, rt);
+		return 1;
+	    }
+	}
+    }
+    return 0;
+}
+
+/* 
+ * check_kernels - Check the portable bitops kernels, then the SIMD
+ * ones if the CPU has them, against the reference functions. Return
+ * number of errors
+ */
+static int check_kernels()
+{
+    int *vals = malloc(KERNEL_VALS * sizeof(int));
+    int *x = malloc(KERNEL_VALS * sizeof(int));
+    int *r = malloc(KERNEL_VALS * sizeof(int));
+    int n = kernel_vals(vals);
+    int errors = 0;
+    int simd, i, k;
+
+    printf("Errors\tKernels\tFunction\n");
+    for (simd = 0; simd < 2; simd++) {
+	char *impl = bitops_init(simd);
+
+	if (simd && strcmp(impl, "portable") == 0) {
+	    printf("No SIMD kernels for this CPU\n");
+	    break;
+	}
+	for (k = 0; kernel_names[k]; k++) {
+	    int kerrors;
+
+	    if (test_fname && strcmp(kernel_names[k], test_fname) != 0)
+		continue;
+	    for (i = 0; test_set[i].solution_funct; i++)
+		if (strcmp(test_set[i].name, kernel_names[k]) == 0)
+		    break;
+	    if (!test_set[i].solution_funct)
+		continue;
+	    kerrors = check_kernel(&test_set[i], vals, n, x, r);
+	    printf(" %d\t%s\t%s\n", kerrors, impl, test_set[i].name);
+	    errors += kerrors;
+	}
+    }
+    free(vals);
+    free(x);
+    free(r);
     return errors;
 }
 
@@ -506,15 +1321,22 @@ static int get_num_val(char *sval, unsigned *valp) {
  * usage - Display usage info
  */
 static void usage(char *cmd) {
-    printf("Usage: %s [-hg] [-r <n>] [-f <name> [-1|-2|-3 <val>]*] [-T <time limit>]\n", cmd);
+    printf("Usage: %s [-behgkw] [-r <n>] [-j <n>] [-z <secs> [-s <seed>]] [-f <name> [-1|-2|-3 <val>]*] [-T <time limit>]\n", cmd);
     printf("  -1 <val>  Specify first function argument\n");
     printf("  -2 <val>  Specify second function argument\n");
     printf("  -3 <val>  Specify third function argument\n");
     printf("  -f <name> Test only the named function\n");
+    printf("  -b        Count cycles per call instead of testing\n");
+    printf("  -e        Test one-argument functions on every possible argument\n");
     printf("  -g        Compact output for grading (with no error msgs)\n");
     printf("  -h        Print this message\n");
+    printf("  -j <n>    Split each function's tests across n threads\n");
+    printf("  -k        Check the bitops kernels against the reference functions\n");
     printf("  -r <n>    Give uniform weight of n for all problems\n");
+    printf("  -s <seed> Seed for -z (default: time of day)\n");
     printf("  -T <lim>  Set timeout limit to lim\n");
+    printf("  -w        Retest changed puzzles whenever bits.c changes\n");
+    printf("  -z <secs> Fuzz each function for secs seconds after it passes\n");
     exit(1);
 }
 
@@ -526,17 +1348,45 @@ static void usage(char *cmd) {
 int main(int argc, char *argv[])
 {
     int errors;
+    int timeout_given = 0;
+    int seed_given = 0;
     char c;
 
     /* parse command line args */
-    while ((c = getopt(argc, argv, "hgf:r:T:1:2:3:")) != -1)
+    while ((c = getopt(argc, argv, "behgkwf:r:j:s:z:T:1:2:3:")) != -1)
         switch (c) {
         case 'h': /* help */
 	    usage(argv[0]);
 	    break;
+	case 'b': /* benchmark */
+	    bench = 1;
+	    break;
+	case 'e': /* exhaustive one-argument tests */
+	    exhaustive = 1;
+	    break;
 	case 'g': /* grading option for autograder */
 	    grade = 1;
 	    break;
+	case 'k': /* check bitops kernels */
+	    kernels = 1;
+	    break;
+	case 'j': /* number of worker threads */
+	    num_workers = atoi(optarg);
+	    if (num_workers < 1)
+		usage(argv[0]);
+	    break;
+	case 'z': /* fuzzing time per function */
+	    fuzz_secs = atoi(optarg);
+	    if (fuzz_secs < 1)
+		usage(argv[0]);
+	    break;
+	case 's': /* fuzzing seed */
+	    fuzz_seed = strtoull(optarg, NULL, 0);
+	    seed_given = 1;
+	    break;
+	case 'w': /* watch bits.c */
+	    watch = 1;
+	    break;
 	case 'f': /* test only one function */
 	    test_fname = strdup(optarg);
 	    break;
@@ -568,17 +1418,32 @@ int main(int argc, char *argv[])
 	    break;
 	case 'T': /* Set timeout limit */
 	    timeout_limit = atoi(optarg);
+	    timeout_given = 1;
 	    break;
 	default:
 	    usage(argv[0]);
 	}
 
+    if (!seed_given) {
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	fuzz_seed = now.tv_sec * 1000000ULL + now.tv_usec;
+    }
+
+    if (exhaustive && !timeout_given)
+	timeout_limit = EXHAUSTIVE_TIMEOUT_LIMIT;
+
     if (timeout_limit > 0) {
 	Signal(SIGALRM, timeout_handler);
     }
 
-    /* test each function */
-    errors = run_tests();
+    /* test (or time) each function */
+    if (watch)
+	errors = watch_tests();
+    else if (kernels)
+	errors = check_kernels();
+    else
+	errors = bench ? run_bench() : run_tests();
 
     return 0;
 }
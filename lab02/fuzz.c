@@ -0,0 +1,314 @@
+/*
+ * CS:APP Data Lab
+ *
+ * fuzz.c - Differential fuzzing of the puzzle functions. See fuzz.h.
+ */
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "btest.h"
+#include "fuzz.h"
+
+/* Edge map size, as log2 */
+#define COV_BITS 16
+
+/* Most edges recorded for one input */
+#define TRACE_MAX 1024
+
+/* Check the clock once per this many inputs */
+#define CLOCK_INTERVAL 4096
+
+/* Corpus size for functions of two or three arguments before any
+   input is generated */
+#define MULTI_SEEDS 256
+
+/* Values near the integer and floating point boundaries */
+static const unsigned interesting[] = {
+    0, 1, 2, 3, 0x7f, 0x80, 0xff, 0x100, 0x7fff, 0x8000, 0xffff,
+    0x10000, 0x7fffffff, 0x80000000, 0x80000001, 0xfffffffe, 0xffffffff,
+    0x00000001, 0x007fffff, 0x00800000, 0x3f800000, 0x4b000000,
+    0x7f7fffff, 0x7f800000, 0x7f800001, 0x7fc00000, 0x807fffff,
+    0x80800000, 0xbf800000, 0xff800000
+};
+#define NUM_INTERESTING (sizeof(interesting) / sizeof(interesting[0]))
+
+/*************
+ * Generator
+ *************/
+
+/* xoshiro128** state */
+static uint32_t rng[4];
+
+static uint32_t rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+static uint32_t next(void)
+{
+    uint32_t result = rotl(rng[1] * 5, 7) * 9;
+    uint32_t t = rng[1] << 9;
+
+    rng[2] ^= rng[0];
+    rng[3] ^= rng[1];
+    rng[1] ^= rng[2];
+    rng[0] ^= rng[3];
+    rng[2] ^= t;
+    rng[3] = rotl(rng[3], 11);
+    return result;
+}
+
+/* Fill the state from seed with splitmix64 */
+static void seed_rng(unsigned long long seed)
+{
+    int i;
+
+    for (i = 0; i < 4; i += 2) {
+	uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	z ^= z >> 31;
+	rng[i] = (uint32_t) z;
+	rng[i + 1] = (uint32_t) (z >> 32);
+    }
+}
+
+/* Uniform in 0..n-1 */
+static unsigned below(unsigned n)
+{
+    return (uint64_t) next() * n >> 32;
+}
+
+/*************
+ * Coverage
+ *************/
+
+static __thread int tracing;
+static __thread unsigned trace[TRACE_MAX];
+static __thread int num_traced;
+static __thread uintptr_t prev_pc;
+
+static unsigned char edge_seen[1 << COV_BITS];
+
+/* Result classes: bit length, separately for negative numbers */
+static unsigned char class_seen[64][64];
+
+/*
+ * __sanitizer_cov_trace_pc - Called by code compiled with
+ * -fsanitize-coverage=trace-pc at the start of each basic block.
+ * Records the edge from the previous block, as AFL does
+ */
+void __sanitizer_cov_trace_pc(void)
+{
+    uintptr_t pc;
+
+    if (!tracing || num_traced == TRACE_MAX)
+	return;
+    pc = (uintptr_t) __builtin_return_address(0);
+    trace[num_traced++] = (pc ^ prev_pc) & ((1 << COV_BITS) - 1);
+    prev_pc = pc >> 1;
+}
+
+static int result_class(int v)
+{
+    unsigned u = v < 0 ? ~v : v;
+    int bits = u ? 32 - __builtin_clz(u) : 0;
+
+    return v < 0 ? 32 + bits : bits;
+}
+
+/*************
+ * Inputs
+ *************/
+
+/* v if it is in range, else v folded into it */
+static int fit(unsigned v, int range[2])
+{
+    unsigned span = (unsigned) range[1] - (unsigned) range[0];
+
+    if ((int) v >= range[0] && (int) v <= range[1])
+	return v;
+    return (int) ((unsigned) range[0] + v % (span + 1));
+}
+
+/* Boundary value j, 0 <= j < NUM_INTERESTING + 2 */
+static int boundary(unsigned j, int range[2])
+{
+    if (j == NUM_INTERESTING)
+	return range[0];
+    if (j == NUM_INTERESTING + 1)
+	return range[1];
+    return fit(interesting[j], range);
+}
+
+/*
+ * mutate - Apply one to three random edits to the arguments a
+ */
+static void mutate(int a[3], int args, int ranges[3][2],
+		   int corpus[][3], int n)
+{
+    int k, rounds = 1 + below(3);
+
+    for (k = 0; k < rounds; k++) {
+	int i = below(args);
+	unsigned v = a[i];
+	int s;
+
+	switch (below(8)) {
+	case 0: /* flip a bit */
+	    v ^= 1u << below(32);
+	    break;
+	case 1: /* small step */
+	    v += (int) below(33) - 16;
+	    break;
+	case 2: /* boundary value */
+	    v = interesting[below(NUM_INTERESTING)];
+	    break;
+	case 3: /* random byte */
+	    s = 8 * below(4);
+	    v = (v & ~(0xffu << s)) | (next() & 0xff) << s;
+	    break;
+	case 4: /* negate or complement */
+	    v = below(2) ? -v : ~v;
+	    break;
+	case 5: /* shift */
+	    v = below(2) ? v << 1 : v >> 1;
+	    break;
+	case 6: /* splice from another input */
+	    v = corpus[below(n)][below(args)];
+	    break;
+	default:
+	    v = next();
+	    break;
+	}
+	a[i] = fit(v, ranges[i]);
+    }
+}
+
+/*************
+ * Testing
+ *************/
+
+static int call(funct_t f, int args, int a[3])
+{
+    switch (args) {
+    case 1:
+	return ((funct1_t) f)(a[0]);
+    case 2:
+	return ((funct2_t) f)(a[0], a[1]);
+    default:
+	return ((funct3_t) f)(a[0], a[1], a[2]);
+    }
+}
+
+static int fails(test_ptr t, int a[3])
+{
+    return call(t->solution_funct, t->args, a) != call(t->test_funct, t->args, a);
+}
+
+/*
+ * minimize - Clear bits of the failing input a, highest first, as
+ * long as it keeps failing, until no bit can be cleared
+ */
+static void minimize(test_ptr t, int ranges[3][2], int a[3])
+{
+    int changed = 1;
+    int i, b;
+
+    while (changed) {
+	changed = 0;
+	for (i = 0; i < t->args; i++) {
+	    for (b = 32; b >= 0; b--) {
+		/* b == 32 tries zero at once */
+		int cur = a[i];
+		int c = b == 32 ? 0 : (int) ((unsigned) cur & ~(1u << b));
+
+		if (c == cur || c < ranges[i][0] || c > ranges[i][1])
+		    continue;
+		a[i] = c;
+		if (fails(t, a))
+		    changed = 1;
+		else
+		    a[i] = cur;
+	    }
+	}
+    }
+}
+
+/*
+ * fuzz_funct - Fuzz t for secs seconds or until a failure. See fuzz.h
+ */
+int fuzz_funct(test_ptr t, int ranges[3][2], double secs,
+	       unsigned long long seed, fuzz_rec *res)
+{
+    static int corpus[FUZZ_CORPUS_MAX][3];
+    int args = t->args;
+    int num_seeds = args == 1 ? NUM_INTERESTING + 2 : MULTI_SEEDS;
+    int n = 0;
+    struct timespec start, now;
+
+    seed_rng(seed);
+    memset(edge_seen, 0, sizeof(edge_seen));
+    memset(class_seen, 0, sizeof(class_seen));
+    res->cases = 0;
+    res->edges = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (;;) {
+	int a[3] = {0, 0, 0};
+	int i, k, r, rt, novel;
+	unsigned char *c;
+
+	if (res->cases < num_seeds) {
+	    /* Boundary values first */
+	    for (i = 0; i < args; i++)
+		a[i] = boundary(args == 1 ? res->cases : below(NUM_INTERESTING + 2),
+				ranges[i]);
+	} else if (below(16) == 0) {
+	    for (i = 0; i < args; i++)
+		a[i] = fit(next(), ranges[i]);
+	} else {
+	    memcpy(a, corpus[below(n)], sizeof(a));
+	    mutate(a, args, ranges, corpus, n);
+	}
+
+	num_traced = 0;
+	prev_pc = 0;
+	tracing = 1;
+	r = call(t->solution_funct, args, a);
+	rt = call(t->test_funct, args, a);
+	tracing = 0;
+	res->cases++;
+
+	if (r != rt) {
+	    minimize(t, ranges, a);
+	    memcpy(res->args, a, sizeof(a));
+	    res->corpus = n;
+	    return 1;
+	}
+
+	novel = res->cases <= num_seeds;
+	for (k = 0; k < num_traced; k++) {
+	    if (!edge_seen[trace[k]]) {
+		edge_seen[trace[k]] = 1;
+		res->edges++;
+		novel = 1;
+	    }
+	}
+	c = &class_seen[result_class(r)][result_class(rt)];
+	if (!*c) {
+	    *c = 1;
+	    novel = 1;
+	}
+	if (novel)
+	    memcpy(corpus[n < FUZZ_CORPUS_MAX ? n++ : below(n)], a, sizeof(a));
+
+	if (res->cases % CLOCK_INTERVAL == 0) {
+	    clock_gettime(CLOCK_MONOTONIC, &now);
+	    if (now.tv_sec - start.tv_sec + (now.tv_nsec - start.tv_nsec) / 1e9 >= secs)
+		break;
+	}
+    }
+    res->corpus = n;
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * CS:APP Data Lab
+ *
+ * fuzz.h - Differential fuzzing of the puzzle functions (btest -z).
+ *
+ * Inputs come from an xoshiro128** generator, either fresh or mutated
+ * from a corpus seeded with boundary values. An input is kept in the
+ * corpus when it reaches a branch edge not seen before, or a new pair
+ * of result classes for the solution and the reference. Edge coverage
+ * needs bits.c compiled with -fsanitize-coverage=trace-pc ("make
+ * btest-cov"); otherwise only the result classes guide the search. A
+ * failing input is minimized by clearing bits while it still fails.
+ * Include after btest.h.
+ */
+
+#define FUZZ_CORPUS_MAX 8192
+
+typedef struct {
+    long long cases; /* inputs evaluated */
+    int corpus;      /* inputs kept */
+    int edges;       /* distinct edges reached, 0 without coverage */
+    int args[3];     /* failing input, minimized */
+} fuzz_rec;
+
+/* Fuzz t with arguments in ranges[i][0]..ranges[i][1] for secs
+   seconds or until a failure. Return 1 if an input failed */
+int fuzz_funct(test_ptr t, int ranges[3][2], double secs,
+	       unsigned long long seed, fuzz_rec *res);
@@ -1,6 +1,8 @@
 /* Display value of fixed point numbers */
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include "stream.h"
 
 /* Extract hex/decimal/or float value from string */
 static int get_num_val(char *sval, unsigned *valp) {
@@ -48,9 +50,43 @@ void show_int(unsigned uf)
 }
 
 
+/*
+ * Streaming mode (-s and -b), through stream.c, with lines of hex,
+ * signed and unsigned
+ */
+static void show_lines(void *data, const void *words, int n)
+{
+  const unsigned *w = words;
+  int i;
+  for (i = 0; i < n; i++) {
+    unsigned uf = w[i];
+    out_str("0x");
+    out_hex(uf, 8);
+    out_char('\t');
+    if ((int) uf < 0) {
+      out_char('-');
+      out_dec(-uf);
+    } else
+      out_dec(uf);
+    out_char('\t');
+    out_dec(uf);
+    out_char('\n');
+  }
+}
+
+static void show_invalid(void *data, const char *tok)
+{
+  fprintf(stderr, "Cannot convert '%s' to 32-bit number\n", tok);
+}
+
+
 void usage(char *fname) {
   printf("Usage: %s val1 val2 ...\n", fname);
+  printf("       %s -s|-b [file ...]\n", fname);
   printf("Values may be given in hex or decimal\n");
+  printf("With -s, decode the values in the files (or stdin), one line each:\n");
+  printf("  hex, signed, unsigned\n");
+  printf("With -b, the files hold raw 32-bit words in native byte order\n");
   exit(0);
 }
 
@@ -60,6 +96,10 @@ int main(int argc, char *argv[])
   unsigned uf;
   if (argc < 2)
     usage(argv[0]);
+  if (strcmp(argv[1], "-s") == 0 || strcmp(argv[1], "-b") == 0) {
+    stream_t s = {32, NULL, show_lines, show_invalid, NULL};
+    return stream(&s, argv[1][1] == 'b', argc-2, argv+2);
+  }
   for (i = 1; i < argc; i++) {
     char *sval = argv[i];
     if (get_num_val(sval, &uf)) {
@@ -0,0 +1,138 @@
+/*
+ * CS:APP Data Lab
+ *
+ * reload.c - Swap in a new build of bits.c. See reload.h.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <link.h>
+#include "btest.h"
+#include "batch.h"
+#include "reload.h"
+
+/* The object in use, or NULL before the first load */
+static void *handle = NULL;
+
+/* Copy of the code of each solution in use, to compare against */
+static unsigned char **code = NULL;
+static size_t *code_size = NULL;
+
+/*
+ * copy_open - dlopen a private copy of so_path, so that a rebuilt
+ * file is never mistaken for one already loaded
+ */
+static void *copy_open(char *so_path)
+{
+    char tmp[] = "/tmp/btest-XXXXXX.so";
+    char buf[8192];
+    FILE *in, *out;
+    size_t n;
+    void *h;
+    int fd;
+
+    if (!(in = fopen(so_path, "rb"))) {
+	perror(so_path);
+	return NULL;
+    }
+    if ((fd = mkstemps(tmp, 3)) < 0 || !(out = fdopen(fd, "wb"))) {
+	perror(tmp);
+	fclose(in);
+	return NULL;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+	fwrite(buf, 1, n, out);
+    fclose(in);
+    fclose(out);
+
+    h = dlopen(tmp, RTLD_NOW | RTLD_LOCAL);
+    if (!h)
+	printf("%s\n", dlerror());
+    unlink(tmp);
+    return h;
+}
+
+/*
+ * code_of - Find the size of the function at f from its symbol.
+ * Return 0 if it is unknown
+ */
+static size_t code_of(void *f)
+{
+    Dl_info info;
+    ElfW(Sym) *sym = NULL;
+
+    if (!dladdr1(f, &info, (void **) &sym, RTLD_DL_SYMENT) || !sym)
+	return 0;
+    return sym->st_size;
+}
+
+/*
+ * reload_bits - Load a new build of bits.c. See reload.h
+ */
+int reload_bits(char *so_path, int changed[])
+{
+    batch_rec *new_batch;
+    funct_t *new_funct;
+    void *h;
+    int i, k, n;
+
+    for (n = 0; test_set[n].solution_funct; n++)
+	;
+    if (!code) {
+	code = calloc(n, sizeof(*code));
+	code_size = calloc(n, sizeof(*code_size));
+    }
+
+    if (!(h = copy_open(so_path)))
+	return -1;
+
+    /* Resolve everything before touching test_set */
+    new_funct = malloc(n * sizeof(funct_t));
+    for (i = 0; i < n; i++) {
+	new_funct[i] = (funct_t) dlsym(h, test_set[i].name);
+	if (!new_funct[i]) {
+	    printf("%s: no function %s\n", so_path, test_set[i].name);
+	    free(new_funct);
+	    dlclose(h);
+	    return -1;
+	}
+    }
+    if (!(new_batch = dlsym(h, "batch_set"))) {
+	printf("%s: no batch_set\n", so_path);
+	free(new_funct);
+	dlclose(h);
+	return -1;
+    }
+
+    for (i = 0; i < n; i++) {
+	unsigned char *f = (unsigned char *) new_funct[i];
+	size_t size = code_of(f);
+
+	/* Unknown sizes count as changed */
+	changed[i] = !handle || size == 0 || size != code_size[i] ||
+	    memcmp(f, code[i], size) != 0;
+	if (changed[i]) {
+	    free(code[i]);
+	    code[i] = malloc(size);
+	    memcpy(code[i], f, size);
+	    code_size[i] = size;
+	}
+	test_set[i].solution_funct = new_funct[i];
+    }
+
+    /* Batches come from the same build; the references stay put */
+    for (k = 0; new_batch[k].name; k++) {
+	batch_ptr b = find_batch(new_batch[k].name);
+	if (b)
+	    b->solution_batch = new_batch[k].solution_batch;
+    }
+
+    free(new_funct);
+    if (handle)
+	dlclose(handle);
+    handle = h;
+    return 0;
+}
@@ -0,0 +1,18 @@
+/*
+ * CS:APP Data Lab
+ *
+ * reload.h - Swap in a new build of bits.c without restarting btest
+ * (btest -w).
+ *
+ * The bits.so target in the Makefile builds batch.c, and with it
+ * bits.c, as a shared object. reload_bits() loads a copy of it and
+ * points the solutions in test_set and batch_set at the new code. A
+ * puzzle has changed when its machine code differs from the last
+ * load; since the coding rules forbid calls and macros, nothing else
+ * in bits.c can change what it computes. Include after btest.h.
+ */
+
+/* Load so_path and set changed[i] to whether the code of test_set[i]
+   differs from the last load (always, on the first). Return 0, or -1
+   if it cannot be loaded, in which case the last load stays in use */
+int reload_bits(char *so_path, int changed[]);
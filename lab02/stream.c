@@ -0,0 +1,206 @@
+/* Streaming mode (-s and -b) shared by fshow and ishow. See stream.h */
+
+#include <stdio.h>
+#include <string.h>
+#include "stream.h"
+
+/* Words are written to stdout through an output buffer */
+#define OUT_SIZE (1<<16)
+
+static char out_buf[OUT_SIZE];
+static int out_len = 0;
+
+void out_flush(void)
+{
+  fwrite(out_buf, 1, out_len, stdout);
+  fflush(stdout);
+  out_len = 0;
+}
+
+/* Make room for n more characters */
+static char *out_room(int n)
+{
+  if (out_len + n > OUT_SIZE)
+    out_flush();
+  return out_buf + out_len;
+}
+
+void out_char(char c)
+{
+  *out_room(1) = c;
+  out_len++;
+}
+
+void out_str(const char *s)
+{
+  while (*s)
+    out_char(*s++);
+}
+
+void out_hex(uint64_t u, int digits)
+{
+  char *p = out_room(digits);
+  int i;
+  for (i = digits-1; i >= 0; i--) {
+    p[i] = "0123456789abcdef"[u & 0xf];
+    u >>= 4;
+  }
+  out_len += digits;
+}
+
+void out_dec(uint64_t u)
+{
+  char tmp[20];
+  int n = 0;
+  do {
+    tmp[n++] = '0' + u % 10;
+    u /= 10;
+  } while (u);
+  while (n > 0)
+    out_char(tmp[--n]);
+}
+
+void out_double(double d, int digits)
+{
+  out_len += snprintf(out_room(32), 32, "%.*g", digits, d);
+}
+
+uint64_t word_mask(int size)
+{
+  return size == 64 ? ~0ULL : (1ULL << size) - 1;
+}
+
+void put_word(int size, void *words, int i, uint64_t u)
+{
+  switch (size) {
+  case 16:
+    ((uint16_t *) words)[i] = u;
+    break;
+  case 32:
+    ((uint32_t *) words)[i] = u;
+    break;
+  default:
+    ((uint64_t *) words)[i] = u;
+    break;
+  }
+}
+
+int parse_word(const char *s, int size, uint64_t *valp)
+{
+  uint64_t mask = word_mask(size);
+  uint64_t v = 0;
+  int neg = 0;
+  int base = 10;
+  int digits = 0;
+  if (*s == '-' || *s == '+')
+    neg = *s++ == '-';
+  if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+    base = 16;
+    s += 2;
+  } else if (s[0] == '0')
+    base = 8;
+  for (; *s; s++, digits++) {
+    int d;
+    if (*s >= '0' && *s <= '9')
+      d = *s - '0';
+    else if ((*s | 0x20) >= 'a' && (*s | 0x20) <= 'f')
+      d = (*s | 0x20) - 'a' + 10;
+    else
+      return 0;
+    if (d >= base || v > (mask - d) / base)
+      return 0;
+    v = v*base + d;
+  }
+  if (!digits || (neg && v > (mask >> 1) + 1))
+    return 0;
+  *valp = (neg ? -v : v) & mask;
+  return 1;
+}
+
+/* Decode the whitespace separated words of in. Return the number of
+   invalid ones */
+static int stream_text(stream_t *s, FILE *in)
+{
+  static uint64_t words[STREAM_WORDS];
+  char tok[MAX_TOKEN+4];
+  int num_words = 0;
+  int n = 0;
+  int too_long = 0;
+  int bad = 0;
+  int c;
+  uint64_t u;
+  do {
+    c = getc_unlocked(in);
+    if (c == EOF || c == ' ' || c == '\n' || c == '\t' || c == '\r') {
+      if (n == 0)
+	continue;
+      tok[n] = '\0';
+      if (!too_long && (parse_word(tok, s->size, &u) ||
+	  (s->convert && s->convert(s->data, tok, &u)))) {
+	put_word(s->size, words, num_words++, u);
+	if (num_words == STREAM_WORDS) {
+	  s->show(s->data, words, num_words);
+	  num_words = 0;
+	}
+      } else {
+	/* Keep the output in order */
+	s->show(s->data, words, num_words);
+	num_words = 0;
+	out_flush();
+	if (too_long)
+	  strcpy(tok + n, "...");
+	s->invalid(s->data, tok);
+	bad++;
+      }
+      n = 0;
+      too_long = 0;
+    } else if (n < MAX_TOKEN)
+      tok[n++] = c;
+    else
+      too_long = 1;
+  } while (c != EOF);
+  s->show(s->data, words, num_words);
+  return bad;
+}
+
+/* Decode in as native words. Return 1 if it ends in a partial word */
+static int stream_binary(stream_t *s, FILE *in)
+{
+  static uint64_t words[STREAM_WORDS];
+  int word_size = s->size/8;
+  size_t n, total = 0;
+  while ((n = fread(words, 1, STREAM_WORDS * word_size, in)) > 0) {
+    s->show(s->data, words, n / word_size);
+    total += n;
+    if (n % word_size)
+      break;
+  }
+  if (total % word_size) {
+    out_flush();
+    fprintf(stderr, "Ignored %d trailing bytes\n", (int) (total % word_size));
+    return 1;
+  }
+  return 0;
+}
+
+int stream(stream_t *s, int binary, int argc, char *argv[])
+{
+  int bad = 0;
+  int i;
+  if (argc == 0)
+    bad += binary ? stream_binary(s, stdin) : stream_text(s, stdin);
+  for (i = 0; i < argc; i++) {
+    FILE *in = strcmp(argv[i], "-") == 0 ? stdin : fopen(argv[i], binary ? "rb" : "r");
+    if (!in) {
+      out_flush();
+      perror(argv[i]);
+      bad++;
+      continue;
+    }
+    bad += binary ? stream_binary(s, in) : stream_text(s, in);
+    if (in != stdin)
+      fclose(in);
+  }
+  out_flush();
+  return bad ? 1 : 0;
+}
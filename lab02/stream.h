@@ -0,0 +1,49 @@
+/* Streaming mode (-s and -b) shared by fshow and ishow */
+
+#include <stdint.h>
+
+/* Longest token read with -s */
+#define MAX_TOKEN 64
+
+/* Most words handed to show at once */
+#define STREAM_WORDS 4096
+
+/* How a tool reads and shows its words */
+typedef struct {
+  int size;          /* Bits per word: 16, 32 or 64 */
+  /* Convert a token that is not an integer, such as a float literal,
+     to a word. Return 0 if it is not one. May be NULL */
+  int (*convert)(void *data, const char *tok, uint64_t *valp);
+  /* Write one line for each of the n words, held in an array of
+     size-bit words, with the out_ functions */
+  void (*show)(void *data, const void *words, int n);
+  /* Report a token that is not a word. It ends in "..." if it was
+     cut short at MAX_TOKEN characters */
+  void (*invalid)(void *data, const char *tok);
+  void *data;        /* Passed to the functions above */
+} stream_t;
+
+/* Decode every word of the named files, or of stdin if argc is 0,
+   as text (-s) or, if binary is set, as native words (-b). Return
+   the exit status */
+int stream(stream_t *s, int binary, int argc, char *argv[]);
+
+/* Parse a whole token as a hex (0x), octal (0) or decimal integer
+   that fits in a size-bit word, negative values down to the most
+   negative word. Return 0 if it is not one */
+int parse_word(const char *s, int size, uint64_t *valp);
+
+/* All ones in the low size bits */
+uint64_t word_mask(int size);
+
+/* Store u as word i of an array of size-bit words */
+void put_word(int size, void *words, int i, uint64_t u);
+
+/* Buffered output for show. Flush before writing to stderr, to keep
+   the output in order */
+void out_flush(void);
+void out_char(char c);
+void out_str(const char *s);
+void out_hex(uint64_t u, int digits);  /* Exactly digits hex digits */
+void out_dec(uint64_t u);
+void out_double(double d, int digits); /* As %.*g */
@@ -93,8 +93,9 @@ int test_isNegative(int x) {
 }
 int test_fitsBits(int x, int n)
 {
-  int TMin_n = -(1 << (n-1));
-  int TMax_n = (1 << (n-1)) - 1;
+  /* In long long, as the bounds for n = 32 overflow an int */
+  long long TMin_n = -(1LL << (n-1));
+  long long TMax_n = (1LL << (n-1)) - 1;
   return x >= TMin_n && x <= TMax_n;
 }
 int test_negate(int x) {
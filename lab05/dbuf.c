@@ -0,0 +1,137 @@
+/*
+ * dbuf.c
+ *
+ * Growable array of doubles. See dbuf.h.
+ */
+
+#define _GNU_SOURCE     // mremap
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "dbuf.h"
+
+/**
+ * Moves the buffer to storage for exactly capacity values
+ *
+ * @param b the buffer
+ * @param capacity the new capacity, at least b->size
+ * @return 0 on success, -1 if out of memory
+ */
+static int resize(dbuf_t *b, size_t capacity) {
+	size_t bytes = capacity*sizeof(double);
+	size_t old_bytes = b->capacity*sizeof(double);
+	void *data;
+
+	if (!b->mapped && bytes < DBUF_MAP_THRESHOLD) {
+		data = realloc(b->data, bytes);
+		if (!data && bytes > 0) return -1;
+	} else if (!b->mapped) {
+		/* crossing the threshold: one last copy into a mapping */
+		data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED) return -1;
+		memcpy(data, b->data, b->size*sizeof(double));
+		free(b->data);
+		b->mapped = 1;
+	} else {
+#ifdef __linux__
+		data = mremap(b->data, old_bytes, bytes, MREMAP_MAYMOVE);
+		if (data == MAP_FAILED) return -1;
+#else
+		data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED) return -1;
+		memcpy(data, b->data, b->size*sizeof(double));
+		munmap(b->data, old_bytes);
+#endif
+	}
+
+	b->data = data;
+	b->capacity = capacity;
+	return 0;
+}
+
+/**
+ * Initializes an empty buffer
+ *
+ * @param b the buffer
+ * @param capacity initial capacity
+ * @return 0 on success, -1 if out of memory
+ */
+int dbuf_init(dbuf_t *b, size_t capacity) {
+	b->data = NULL;
+	b->size = 0;
+	b->capacity = 0;
+	b->mapped = 0;
+	return resize(b, capacity);
+}
+
+/**
+ * Makes room for at least capacity values
+ *
+ * @param b the buffer
+ * @param capacity the capacity wanted
+ * @return 0 on success, -1 if out of memory
+ */
+int dbuf_reserve(dbuf_t *b, size_t capacity) {
+	if (capacity <= b->capacity) {
+		return 0;
+	}
+	return resize(b, capacity);
+}
+
+/**
+ * Makes room for at least one more value, growing by half
+ *
+ * @param b the buffer
+ * @return 0 on success, -1 if out of memory
+ */
+int dbuf_grow(dbuf_t *b) {
+	size_t capacity = b->capacity + b->capacity/2;
+	if (capacity < 16) {
+		capacity = 16;
+	}
+	return dbuf_reserve(b, capacity);
+}
+
+/**
+ * Appends a value
+ *
+ * @param b the buffer
+ * @param x the value
+ * @return 0 on success, -1 if out of memory
+ */
+int dbuf_push(dbuf_t *b, double x) {
+	if (b->size == b->capacity && dbuf_grow(b) == -1) {
+		return -1;
+	}
+	b->data[b->size++] = x;
+	return 0;
+}
+
+/**
+ * Releases unused capacity
+ *
+ * @param b the buffer
+ */
+void dbuf_shrink(dbuf_t *b) {
+	if (b->size < b->capacity && b->size > 0) {
+		resize(b, b->size);
+	}
+}
+
+/**
+ * Frees the buffer's storage
+ *
+ * @param b the buffer
+ */
+void dbuf_free(dbuf_t *b) {
+	if (b->mapped) {
+		munmap(b->data, b->capacity*sizeof(double));
+	} else {
+		free(b->data);
+	}
+	b->data = NULL;
+	b->size = 0;
+	b->capacity = 0;
+	b->mapped = 0;
+}
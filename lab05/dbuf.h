@@ -0,0 +1,69 @@
+#ifndef _DBUF_H_
+#define _DBUF_H_
+/*
+ * Growable array of doubles for lab 5.
+ *
+ * Capacity grows by half again each time it runs out, so appending n
+ * values costs O(n) copies overall and at most a third of the array
+ * goes unused. Small buffers live on the heap. Once a buffer passes
+ * DBUF_MAP_THRESHOLD bytes it is moved to its own anonymous mapping,
+ * which on Linux grows with mremap: the kernel remaps the pages
+ * instead of copying them.
+ */
+
+#include <stddef.h>
+
+/* Buffers at least this many bytes are mapped rather than malloc'd */
+#define DBUF_MAP_THRESHOLD (1 << 20)
+
+typedef struct {
+	double *data;
+	size_t size;        // values stored
+	size_t capacity;    // values that fit without growing
+	int mapped;         // whether data is an anonymous mapping
+} dbuf_t;
+
+/*
+ * initializes an empty buffer
+ * @param b the buffer
+ * @param capacity initial capacity
+ * @return 0 on success, -1 if out of memory
+ */
+int dbuf_init(dbuf_t *b, size_t capacity);
+
+/*
+ * makes room for at least capacity values
+ * @param b the buffer
+ * @param capacity the capacity wanted
+ * @return 0 on success, -1 if out of memory (b is unchanged)
+ */
+int dbuf_reserve(dbuf_t *b, size_t capacity);
+
+/*
+ * makes room for at least one more value, growing geometrically
+ * @param b the buffer
+ * @return 0 on success, -1 if out of memory (b is unchanged)
+ */
+int dbuf_grow(dbuf_t *b);
+
+/*
+ * appends a value
+ * @param b the buffer
+ * @param x the value
+ * @return 0 on success, -1 if out of memory
+ */
+int dbuf_push(dbuf_t *b, double x);
+
+/*
+ * releases unused capacity
+ * @param b the buffer
+ */
+void dbuf_shrink(dbuf_t *b);
+
+/*
+ * frees the buffer's storage
+ * @param b the buffer
+ */
+void dbuf_free(dbuf_t *b);
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * group.c
+ *
+ * Per-group statistics over many files. See group.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "readfile.h"
+#include "group.h"
+
+#define INITIAL_CAPACITY 64
+
+typedef struct {
+	char **files;
+	int num_files;
+	int keyed;
+	int *next;          // shared index of the next file to take
+	group_table_t *table;
+	long invalid;
+	int failed;
+} worker_t;
+
+static int isSpace(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * FNV-1a hash of a string
+ */
+static uint64_t hash(const char *key) {
+	uint64_t h = UINT64_C(14695981039346656037);
+	for (; *key; key++) {
+		h = (h ^ (unsigned char)*key)*UINT64_C(1099511628211);
+	}
+	return h;
+}
+
+/**
+ * Finds the slot holding key, or the empty slot where it belongs
+ */
+static group_t *probe(group_t *slots, size_t capacity, const char *key) {
+	size_t i = hash(key) & (capacity - 1);
+	while (slots[i].key && strcmp(slots[i].key, key) != 0) {
+		i = (i + 1) & (capacity - 1);
+	}
+	return &slots[i];
+}
+
+/**
+ * Doubles the number of slots
+ */
+static void grow(group_table_t *t) {
+	size_t capacity = t->capacity*2;
+	group_t *slots = calloc(capacity, sizeof(group_t));
+
+	for (size_t i = 0; i < t->capacity; i++) {
+		if (t->slots[i].key) {
+			*probe(slots, capacity, t->slots[i].key) = t->slots[i];
+		}
+	}
+	free(t->slots);
+	t->slots = slots;
+	t->capacity = capacity;
+}
+
+/**
+ * Creates an empty table
+ *
+ * @param compression the compression of each group's t-digest
+ * @return the table
+ */
+group_table_t *group_table_new(double compression) {
+	group_table_t *t = malloc(sizeof(group_table_t));
+	t->slots = calloc(INITIAL_CAPACITY, sizeof(group_t));
+	t->capacity = INITIAL_CAPACITY;
+	t->count = 0;
+	t->compression = compression;
+	return t;
+}
+
+/**
+ * Frees a table and its groups
+ *
+ * @param t the table
+ */
+void group_table_free(group_table_t *t) {
+	for (size_t i = 0; i < t->capacity; i++) {
+		if (t->slots[i].key) {
+			free(t->slots[i].key);
+			tdigest_free(t->slots[i].sketch);
+		}
+	}
+	free(t->slots);
+	free(t);
+}
+
+/**
+ * Finds a group, adding an empty one if the key is new
+ *
+ * @param t the table
+ * @param key the key
+ * @return the group
+ */
+group_t *group_find(group_table_t *t, const char *key) {
+	group_t *g = probe(t->slots, t->capacity, key);
+	if (g->key) {
+		return g;
+	}
+
+	/* keep the load under 3/4 so probes stay short */
+	if ((t->count + 1)*4 > t->capacity*3) {
+		grow(t);
+		g = probe(t->slots, t->capacity, key);
+	}
+	g->key = strdup(key);
+	g->sketch = tdigest_new(t->compression);
+	accum_init(&g->acc);
+	t->count++;
+	return g;
+}
+
+/**
+ * Merges every group of from into t
+ *
+ * @param t the table to update
+ * @param from the table to merge in
+ */
+void group_table_merge(group_table_t *t, const group_table_t *from) {
+	for (size_t i = 0; i < from->capacity; i++) {
+		const group_t *src = &from->slots[i];
+		if (src->key) {
+			group_t *g = group_find(t, src->key);
+			accum_merge(&g->acc, &src->acc);
+			tdigest_merge(g->sketch, src->sketch);
+		}
+	}
+}
+
+static int compare_groups(const void *a, const void *b) {
+	return strcmp((*(group_t * const *)a)->key, (*(group_t * const *)b)->key);
+}
+
+/**
+ * Lists the groups in key order
+ *
+ * @param t the table
+ * @return array of t->count groups, to be freed by the caller
+ */
+group_t **group_sorted(group_table_t *t) {
+	group_t **groups = malloc(sizeof(group_t *)*(t->count + 1));
+	size_t n = 0;
+
+	for (size_t i = 0; i < t->capacity; i++) {
+		if (t->slots[i].key) {
+			groups[n++] = &t->slots[i];
+		}
+	}
+	qsort(groups, n, sizeof(group_t *), compare_groups);
+	return groups;
+}
+
+/**
+ * Adds a "key value" line to the worker's table
+ *
+ * @param w the worker
+ * @param line the line, modified in place
+ */
+static void addKeyed(worker_t *w, char *line) {
+	char *key = line;
+	while (isSpace(*key)) key++;
+	if (*key == '\0') {
+		return;
+	}
+
+	char *p = key;
+	while (*p && !isSpace(*p)) p++;
+	char *key_end = p;
+	while (isSpace(*p)) p++;
+
+	char *value = p;
+	while (*p && !isSpace(*p)) p++;
+	int value_len = p - value;
+	while (isSpace(*p)) p++;
+
+	double x;
+	if (value_len == 0 || *p != '\0' || parseDouble(value, value_len, &x) != value_len) {
+		w->invalid++;
+		return;
+	}
+
+	*key_end = '\0';
+	group_t *g = group_find(w->table, key);
+	accum_add(&g->acc, x);
+	tdigest_add(g->sketch, x);
+}
+
+/**
+ * Adds every value on a line to a group
+ *
+ * @param w the worker
+ * @param g the group
+ * @param line the line
+ */
+static void addValues(worker_t *w, group_t *g, const char *line) {
+	const char *p = line;
+	for (;;) {
+		while (isSpace(*p)) p++;
+		if (*p == '\0') {
+			return;
+		}
+
+		const char *end = p;
+		while (*end && !isSpace(*end)) end++;
+		double x;
+		if (parseDouble(p, end - p, &x) == end - p) {
+			accum_add(&g->acc, x);
+			tdigest_add(g->sketch, x);
+		} else {
+			w->invalid++;
+		}
+		p = end;
+	}
+}
+
+/**
+ * Thread body: reads files until none are left
+ *
+ * @param arg the worker
+ */
+static void *work(void *arg) {
+	worker_t *w = arg;
+	char *line = NULL;
+	size_t cap = 0;
+	int i;
+
+	while ((i = __atomic_fetch_add(w->next, 1, __ATOMIC_RELAXED)) < w->num_files) {
+		FILE *f = fopen(w->files[i], "r");
+		if (!f) {
+			fprintf(stderr, "There was an error opening the file: %s\n", w->files[i]);
+			w->failed++;
+			continue;
+		}
+
+		group_t *g = w->keyed ? NULL : group_find(w->table, w->files[i]);
+		while (getline(&line, &cap, f) != -1) {
+			if (w->keyed) {
+				addKeyed(w, line);
+			} else {
+				addValues(w, g, line);
+			}
+		}
+		fclose(f);
+	}
+
+	free(line);
+	return NULL;
+}
+
+/**
+ * Aggregates files into groups using a pool of threads
+ *
+ * @param files the file names
+ * @param num_files the number of files
+ * @param keyed whether lines are "key value" pairs
+ * @param threads the number of threads, 0 for one per online CPU
+ * @param t the table to merge the results into
+ * @param invalid set to the number of skipped tokens or lines
+ * @return the number of files that could not be read
+ */
+int groupFiles(char **files, int num_files, int keyed, int threads, group_table_t *t, long *invalid) {
+	if (threads <= 0) {
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (threads > num_files) {
+		threads = num_files;
+	}
+
+	int next = 0;
+	int failed = 0;
+	worker_t *workers = malloc(sizeof(worker_t)*threads);
+	pthread_t *tids = malloc(sizeof(pthread_t)*threads);
+
+	for (int i = 0; i < threads; i++) {
+		workers[i].files = files;
+		workers[i].num_files = num_files;
+		workers[i].keyed = keyed;
+		workers[i].next = &next;
+		workers[i].table = group_table_new(t->compression);
+		workers[i].invalid = 0;
+		workers[i].failed = 0;
+		pthread_create(&tids[i], NULL, work, &workers[i]);
+	}
+
+	*invalid = 0;
+	for (int i = 0; i < threads; i++) {
+		pthread_join(tids[i], NULL);
+		group_table_merge(t, workers[i].table);
+		group_table_free(workers[i].table);
+		*invalid += workers[i].invalid;
+		failed += workers[i].failed;
+	}
+
+	free(workers);
+	free(tids);
+	return failed;
+}
@@ -0,0 +1,82 @@
+#ifndef _GROUP_H_
+#define _GROUP_H_
+/*
+ * Per-group statistics over many files for lab 5.
+ *
+ * A group_table_t maps a key to the running statistics and t-digest of
+ * the values seen for it, in an open-addressing hash table. groupFiles()
+ * reads a list of files on a pool of threads: each thread takes the
+ * next unread file, aggregates into a table of its own, and the tables
+ * are merged at the end.
+ *
+ * Files are either plain lists of numbers, each file being one group
+ * keyed by its name, or "key value" lines, grouped by key across all
+ * files.
+ */
+
+#include <stddef.h>
+#include "running.h"
+#include "tdigest.h"
+
+typedef struct {
+	char *key;          // NULL for an empty slot
+	accum_t acc;
+	tdigest_t *sketch;
+} group_t;
+
+typedef struct {
+	group_t *slots;
+	size_t capacity;    // a power of two
+	size_t count;
+	double compression;
+} group_table_t;
+
+/*
+ * creates an empty table
+ * @param compression the compression of each group's t-digest
+ * @return the table
+ */
+group_table_t *group_table_new(double compression);
+
+/*
+ * frees a table and its groups
+ * @param t the table
+ */
+void group_table_free(group_table_t *t);
+
+/*
+ * finds a group, adding an empty one if the key is new
+ * @param t the table
+ * @param key the key
+ * @return the group
+ */
+group_t *group_find(group_table_t *t, const char *key);
+
+/*
+ * merges every group of from into t
+ * @param t the table to update
+ * @param from the table to merge in
+ */
+void group_table_merge(group_table_t *t, const group_table_t *from);
+
+/*
+ * lists the groups in key order
+ * @param t the table
+ * @return array of t->count groups, to be freed by the caller
+ */
+group_t **group_sorted(group_table_t *t);
+
+/*
+ * aggregates files into groups using a pool of threads
+ * @param files the file names
+ * @param num_files the number of files
+ * @param keyed whether lines are "key value" pairs rather than values
+ *              grouped by file
+ * @param threads the number of threads, 0 for one per online CPU
+ * @param t the table to merge the results into
+ * @param invalid set to the number of skipped tokens or lines
+ * @return the number of files that could not be read
+ */
+int groupFiles(char **files, int num_files, int keyed, int threads, group_table_t *t, long *invalid);
+
+#endif
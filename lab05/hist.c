@@ -0,0 +1,140 @@
+/*
+ * hist.c
+ *
+ * Log-linear histograms. See hist.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "hist.h"
+
+/* IEEE 754 double layout */
+#define MANT_BITS 52
+#define EXP_BIAS 1023
+
+/**
+ * Creates an empty histogram
+ *
+ * @param sub_bits log2 of the buckets per power of two
+ * @return the histogram
+ */
+hist_t *hist_new(int sub_bits) {
+	hist_t *h = malloc(sizeof(hist_t));
+	h->sub_bits = sub_bits;
+	h->num_buckets = (long)(HIST_MAX_EXP - HIST_MIN_EXP) << sub_bits;
+	h->counts = calloc(h->num_buckets, sizeof(long));
+	h->total = 0;
+	h->below = 0;
+	h->above = 0;
+	h->min = INFINITY;
+	h->max = -INFINITY;
+	return h;
+}
+
+/**
+ * Frees a histogram
+ *
+ * @param h the histogram
+ */
+void hist_free(hist_t *h) {
+	free(h->counts);
+	free(h);
+}
+
+/**
+ * Counts a value
+ *
+ * @param h the histogram
+ * @param x the value
+ */
+void hist_add(hist_t *h, double x) {
+	uint64_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	int exp = (int)((bits >> MANT_BITS) & 0x7ff) - EXP_BIAS;
+
+	if (isnan(x)) {
+		return;
+	}
+	h->total++;
+	if (x < h->min) h->min = x;
+	if (x > h->max) h->max = x;
+
+	if ((bits >> 63) || exp < HIST_MIN_EXP) {
+		h->below++;
+	} else if (exp >= HIST_MAX_EXP) {
+		h->above++;
+	} else {
+		long sub = (long)(bits >> (MANT_BITS - h->sub_bits)) & ((1L << h->sub_bits) - 1);
+		h->counts[((long)(exp - HIST_MIN_EXP) << h->sub_bits) | sub]++;
+	}
+}
+
+/**
+ * Adds the counts of other to h
+ *
+ * @param h the histogram to update
+ * @param other a histogram with the same sub_bits
+ * @return 0 on success, -1 if the histograms are not compatible
+ */
+int hist_merge(hist_t *h, const hist_t *other) {
+	if (h->sub_bits != other->sub_bits) {
+		return -1;
+	}
+	for (long i = 0; i < h->num_buckets; i++) {
+		h->counts[i] += other->counts[i];
+	}
+	h->total += other->total;
+	h->below += other->below;
+	h->above += other->above;
+	if (other->min < h->min) h->min = other->min;
+	if (other->max > h->max) h->max = other->max;
+	return 0;
+}
+
+/**
+ * Finds the lowest value in a bucket
+ *
+ * @param h the histogram
+ * @param i a bucket index, up to num_buckets for the end of the range
+ * @return the value
+ */
+double hist_bucket_low(const hist_t *h, long i) {
+	long sub = i & ((1L << h->sub_bits) - 1);
+	int exp = (int)(i >> h->sub_bits) + HIST_MIN_EXP;
+	return ldexp(1 + (double)sub/(1L << h->sub_bits), exp);
+}
+
+/**
+ * Estimates a percentile, placing the ranks inside a bucket evenly
+ * across it
+ *
+ * @param h the histogram
+ * @param q the quantile
+ * @return the estimate
+ */
+double hist_quantile(const hist_t *h, double q) {
+	if (h->total == 0) {
+		return NAN;
+	}
+
+	double rank = q*(h->total - 1);
+	double seen = h->below;
+	if (rank < seen) {
+		return h->min;
+	}
+
+	for (long i = 0; i < h->num_buckets; i++) {
+		if (h->counts[i] > 0 && rank < seen + h->counts[i]) {
+			double low = hist_bucket_low(h, i);
+			double high = hist_bucket_low(h, i + 1);
+			double x = low + (high - low)*(rank - seen + 0.5)/h->counts[i];
+			if (x < h->min) x = h->min;
+			if (x > h->max) x = h->max;
+			return x;
+		}
+		seen += h->counts[i];
+	}
+	return h->max;
+}
@@ -0,0 +1,77 @@
+#ifndef _HIST_H_
+#define _HIST_H_
+/*
+ * Log-linear (HDR-style) histograms of positive doubles for lab 5.
+ *
+ * Each power of two between 2^HIST_MIN_EXP and 2^HIST_MAX_EXP is split
+ * into 2^sub_bits equal buckets, so a bucket is never wider than
+ * 2^-sub_bits of the values in it. The bucket of a value comes straight
+ * from the bits of its exponent and top mantissa bits, which makes an
+ * insert O(1). Memory is fixed by sub_bits, and histograms with the
+ * same sub_bits merge by adding counts.
+ *
+ * Values below the range (including zero and negatives) and above it
+ * are only counted.
+ */
+
+#define HIST_MIN_EXP (-32)
+#define HIST_MAX_EXP 32
+
+/* 2^-7: under 0.8% relative error */
+#define HIST_DEFAULT_SUB_BITS 7
+
+typedef struct {
+	int sub_bits;
+	long *counts;
+	long num_buckets;
+	long total;         // including out of range values
+	long below;
+	long above;
+	double min;
+	double max;
+} hist_t;
+
+/*
+ * creates an empty histogram
+ * @param sub_bits log2 of the buckets per power of two, 1 to 16
+ * @return the histogram
+ */
+hist_t *hist_new(int sub_bits);
+
+/*
+ * frees a histogram
+ * @param h the histogram
+ */
+void hist_free(hist_t *h);
+
+/*
+ * counts a value (NaN is ignored)
+ * @param h the histogram
+ * @param x the value
+ */
+void hist_add(hist_t *h, double x);
+
+/*
+ * adds the counts of other to h
+ * @param h the histogram to update
+ * @param other a histogram with the same sub_bits
+ * @return 0 on success, -1 if the histograms are not compatible
+ */
+int hist_merge(hist_t *h, const hist_t *other);
+
+/*
+ * @param h the histogram
+ * @param i a bucket index
+ * @return the lowest value in the bucket
+ */
+double hist_bucket_low(const hist_t *h, long i);
+
+/*
+ * estimates a percentile from the bucket holding its rank
+ * @param h the histogram
+ * @param q the quantile, 0 <= q <= 1
+ * @return the estimate, NaN if the histogram is empty
+ */
+double hist_quantile(const hist_t *h, double q);
+
+#endif
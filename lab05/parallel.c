@@ -0,0 +1,167 @@
+/*
+ * parallel.c
+ *
+ * Multithreaded parse-and-reduce. See parallel.h.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "readfile.h"
+#include "parallel.h"
+
+/* Longest token copied out for the file's final number */
+#define MAX_TOKEN 512
+
+typedef struct {
+	const char *begin;
+	const char *end;
+	int last;           /* whether this chunk ends the file */
+	accum_t acc;
+	tdigest_t *sketch;
+	long invalid;
+} chunk_t;
+
+/**
+ * Parses the whitespace separated token at p, which must be followed
+ * by whitespace or a NUL before any unmapped memory
+ *
+ * @param c the chunk to add the value to
+ * @param p start of the token
+ * @return pointer just past the token
+ */
+static const char *parseToken(chunk_t *c, const char *p) {
+	const char *end = p;
+	double x;
+
+	while (*end && !isspace((unsigned char)*end)) end++;
+	if (parseDouble(p, end - p, &x) == end - p) {
+		accum_add(&c->acc, x);
+		tdigest_add(c->sketch, x);
+	} else {
+		c->invalid++;
+	}
+	return end;
+}
+
+/**
+ * Thread body: parses every token that starts inside the chunk
+ *
+ * @param arg the chunk
+ */
+static void *parseChunk(void *arg) {
+	chunk_t *c = arg;
+	const char *p = c->begin;
+	const char *end = c->end;
+	char tail[MAX_TOKEN + 1];
+	size_t tail_len = 0;
+
+	/* The file's final token may run into the end of the mapping, so
+	   it is copied out and NUL terminated */
+	if (c->last) {
+		const char *t = end;
+		while (t > p && !isspace((unsigned char)t[-1])) t--;
+		tail_len = end - t;
+		end = t;
+	}
+
+	while (p < end) {
+		if (isspace((unsigned char)*p)) {
+			p++;
+		} else {
+			p = parseToken(c, p);
+		}
+	}
+
+	if (tail_len > MAX_TOKEN) {
+		c->invalid++;
+	} else if (tail_len > 0) {
+		memcpy(tail, end, tail_len);
+		tail[tail_len] = '\0';
+		parseToken(c, tail);
+	}
+	return NULL;
+}
+
+/**
+ * Computes statistics over a file using several threads
+ *
+ * @param filename the file to read
+ * @param threads number of threads, 0 for one per online CPU
+ * @param acc the accumulator to merge the results into
+ * @param sketch the digest to merge the results into
+ * @param invalid set to the number of skipped tokens
+ * @return 0 on success, -1 if the file cannot be read
+ */
+int parallelValues(char *filename, int threads, accum_t *acc, tdigest_t *sketch, long *invalid) {
+	struct stat st;
+	int fd = open(filename, O_RDONLY);
+	if (fd == -1 || fstat(fd, &st) == -1) {
+		if (fd != -1) close(fd);
+		return -1;
+	}
+
+	*invalid = 0;
+	size_t size = st.st_size;
+	if (size == 0) {
+		close(fd);
+		return 0;
+	}
+
+	const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return -1;
+	}
+	posix_madvise((void *)data, size, POSIX_MADV_SEQUENTIAL);
+
+	if (threads <= 0) {
+		threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if ((size_t)threads > size) {
+		threads = (int)size;
+	}
+
+	chunk_t *chunks = malloc(sizeof(chunk_t)*threads);
+	pthread_t *tids = malloc(sizeof(pthread_t)*threads);
+
+	/* Cut at whitespace: a cut that lands inside a token moves past it */
+	const char *prev = data;
+	for (int i = 0; i < threads; i++) {
+		const char *cut = data + size*(i + 1)/threads;
+		if (cut < prev) cut = prev;
+		while (cut < data + size && cut > prev && !isspace((unsigned char)cut[-1])) cut++;
+
+		chunks[i].begin = prev;
+		chunks[i].end = cut;
+		chunks[i].last = (cut == data + size);
+		chunks[i].sketch = tdigest_new(sketch->compression);
+		chunks[i].invalid = 0;
+		accum_init(&chunks[i].acc);
+		prev = cut;
+	}
+
+	for (int i = 0; i < threads; i++) {
+		pthread_create(&tids[i], NULL, parseChunk, &chunks[i]);
+	}
+	for (int i = 0; i < threads; i++) {
+		pthread_join(tids[i], NULL);
+		accum_merge(acc, &chunks[i].acc);
+		tdigest_merge(sketch, chunks[i].sketch);
+		tdigest_free(chunks[i].sketch);
+		*invalid += chunks[i].invalid;
+	}
+
+	free(chunks);
+	free(tids);
+	munmap((void *)data, size);
+	return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+/*
+ * Multithreaded parse-and-reduce over a file of whitespace separated
+ * numbers for lab 5.
+ *
+ * The file is mapped into memory and cut into one chunk per thread,
+ * with each cut moved forward to the next whitespace so no number is
+ * split. Every thread parses its chunk into its own accumulator and
+ * t-digest; the partial results are merged once all threads finish.
+ *
+ * Unlike readDouble(), which stops at the first token that is not a
+ * number, invalid tokens are skipped and counted.
+ */
+
+#include "running.h"
+#include "tdigest.h"
+
+/*
+ * computes statistics over a file using several threads
+ * @param filename the file to read
+ * @param threads number of threads, 0 for one per online CPU
+ * @param acc the accumulator to merge the results into
+ * @param sketch the digest to merge the results into
+ * @param invalid set to the number of skipped tokens
+ * @return 0 on success, -1 if the file cannot be read
+ */
+int parallelValues(char *filename, int threads, accum_t *acc, tdigest_t *sketch, long *invalid);
+
+#endif
@@ -0,0 +1,322 @@
+/*
+ * reduce.c
+ *
+ * Vectorized reductions. See reduce.h.
+ */
+
+#include <string.h>
+#include "reduce.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/* Kahan step on one vector of lanes: s += x, carrying the lost low
+   bits in c */
+#define KAHAN_PD(type, add, sub, s, c, x) do { \
+	type y_ = sub((x), (c)); \
+	type t_ = add((s), y_); \
+	(c) = sub(sub(t_, (s)), y_); \
+	(s) = t_; \
+} while (0)
+
+static void kahan(double *s, double *c, double x) {
+	double y = x - *c;
+	double t = *s + y;
+	*c = (t - *s) - y;
+	*s = t;
+}
+
+/**
+ * Folds per-lane Kahan sums into a running scalar Kahan sum
+ *
+ * @param sum the scalar sum
+ * @param comp its compensation
+ * @param s lane sums
+ * @param c lane compensations
+ * @param lanes the number of lanes
+ */
+static void combine(double *sum, double *comp, const double *s, const double *c, int lanes) {
+	for (int i = 0; i < lanes; i++) {
+		kahan(sum, comp, s[i]);
+		kahan(sum, comp, -c[i]);
+	}
+}
+
+/* Plain C */
+
+static double sum_scalar(const double *a, size_t n) {
+	double s = 0, c = 0;
+	for (size_t i = 0; i < n; i++) {
+		kahan(&s, &c, a[i]);
+	}
+	return s;
+}
+
+static double sqdev_scalar(const double *a, size_t n, double mean) {
+	double s = 0, c = 0;
+	for (size_t i = 0; i < n; i++) {
+		double d = a[i] - mean;
+		kahan(&s, &c, d*d);
+	}
+	return s;
+}
+
+static void minmax_scalar(const double *a, size_t n, double *min, double *max) {
+	double lo = a[0], hi = a[0];
+	for (size_t i = 1; i < n; i++) {
+		if (a[i] < lo) lo = a[i];
+		if (a[i] > hi) hi = a[i];
+	}
+	*min = lo;
+	*max = hi;
+}
+
+#ifdef HAVE_X86
+
+/* SSE2: two accumulators of two lanes */
+
+__attribute__((target("sse2")))
+static double sum_sse2(const double *a, size_t n) {
+	__m128d s0 = _mm_setzero_pd(), s1 = s0, c0 = s0, c1 = s0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		KAHAN_PD(__m128d, _mm_add_pd, _mm_sub_pd, s0, c0, _mm_loadu_pd(a + i));
+		KAHAN_PD(__m128d, _mm_add_pd, _mm_sub_pd, s1, c1, _mm_loadu_pd(a + i + 2));
+	}
+
+	double s[4], c[4], sum = 0, comp = 0;
+	_mm_storeu_pd(s, s0);
+	_mm_storeu_pd(s + 2, s1);
+	_mm_storeu_pd(c, c0);
+	_mm_storeu_pd(c + 2, c1);
+	combine(&sum, &comp, s, c, 4);
+	for (; i < n; i++) {
+		kahan(&sum, &comp, a[i]);
+	}
+	return sum;
+}
+
+__attribute__((target("sse2")))
+static double sqdev_sse2(const double *a, size_t n, double mean) {
+	__m128d m = _mm_set1_pd(mean);
+	__m128d s0 = _mm_setzero_pd(), s1 = s0, c0 = s0, c1 = s0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128d d0 = _mm_sub_pd(_mm_loadu_pd(a + i), m);
+		__m128d d1 = _mm_sub_pd(_mm_loadu_pd(a + i + 2), m);
+		KAHAN_PD(__m128d, _mm_add_pd, _mm_sub_pd, s0, c0, _mm_mul_pd(d0, d0));
+		KAHAN_PD(__m128d, _mm_add_pd, _mm_sub_pd, s1, c1, _mm_mul_pd(d1, d1));
+	}
+
+	double s[4], c[4], sum = 0, comp = 0;
+	_mm_storeu_pd(s, s0);
+	_mm_storeu_pd(s + 2, s1);
+	_mm_storeu_pd(c, c0);
+	_mm_storeu_pd(c + 2, c1);
+	combine(&sum, &comp, s, c, 4);
+	for (; i < n; i++) {
+		double d = a[i] - mean;
+		kahan(&sum, &comp, d*d);
+	}
+	return sum;
+}
+
+__attribute__((target("sse2")))
+static void minmax_sse2(const double *a, size_t n, double *min, double *max) {
+	__m128d lo0 = _mm_set1_pd(a[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128d x0 = _mm_loadu_pd(a + i);
+		__m128d x1 = _mm_loadu_pd(a + i + 2);
+		lo0 = _mm_min_pd(lo0, x0);
+		lo1 = _mm_min_pd(lo1, x1);
+		hi0 = _mm_max_pd(hi0, x0);
+		hi1 = _mm_max_pd(hi1, x1);
+	}
+
+	double lo[2], hi[2], unused;
+	_mm_storeu_pd(lo, _mm_min_pd(lo0, lo1));
+	_mm_storeu_pd(hi, _mm_max_pd(hi0, hi1));
+	minmax_scalar(lo, 2, min, &unused);
+	minmax_scalar(hi, 2, &unused, max);
+	for (; i < n; i++) {
+		if (a[i] < *min) *min = a[i];
+		if (a[i] > *max) *max = a[i];
+	}
+}
+
+/* AVX2: two accumulators of four lanes */
+
+__attribute__((target("avx2")))
+static double sum_avx2(const double *a, size_t n) {
+	__m256d s0 = _mm256_setzero_pd(), s1 = s0, c0 = s0, c1 = s0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		KAHAN_PD(__m256d, _mm256_add_pd, _mm256_sub_pd, s0, c0, _mm256_loadu_pd(a + i));
+		KAHAN_PD(__m256d, _mm256_add_pd, _mm256_sub_pd, s1, c1, _mm256_loadu_pd(a + i + 4));
+	}
+
+	double s[8], c[8], sum = 0, comp = 0;
+	_mm256_storeu_pd(s, s0);
+	_mm256_storeu_pd(s + 4, s1);
+	_mm256_storeu_pd(c, c0);
+	_mm256_storeu_pd(c + 4, c1);
+	combine(&sum, &comp, s, c, 8);
+	for (; i < n; i++) {
+		kahan(&sum, &comp, a[i]);
+	}
+	return sum;
+}
+
+__attribute__((target("avx2")))
+static double sqdev_avx2(const double *a, size_t n, double mean) {
+	__m256d m = _mm256_set1_pd(mean);
+	__m256d s0 = _mm256_setzero_pd(), s1 = s0, c0 = s0, c1 = s0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), m);
+		__m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), m);
+		KAHAN_PD(__m256d, _mm256_add_pd, _mm256_sub_pd, s0, c0, _mm256_mul_pd(d0, d0));
+		KAHAN_PD(__m256d, _mm256_add_pd, _mm256_sub_pd, s1, c1, _mm256_mul_pd(d1, d1));
+	}
+
+	double s[8], c[8], sum = 0, comp = 0;
+	_mm256_storeu_pd(s, s0);
+	_mm256_storeu_pd(s + 4, s1);
+	_mm256_storeu_pd(c, c0);
+	_mm256_storeu_pd(c + 4, c1);
+	combine(&sum, &comp, s, c, 8);
+	for (; i < n; i++) {
+		double d = a[i] - mean;
+		kahan(&sum, &comp, d*d);
+	}
+	return sum;
+}
+
+__attribute__((target("avx2")))
+static void minmax_avx2(const double *a, size_t n, double *min, double *max) {
+	__m256d lo0 = _mm256_set1_pd(a[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256d x0 = _mm256_loadu_pd(a + i);
+		__m256d x1 = _mm256_loadu_pd(a + i + 4);
+		lo0 = _mm256_min_pd(lo0, x0);
+		lo1 = _mm256_min_pd(lo1, x1);
+		hi0 = _mm256_max_pd(hi0, x0);
+		hi1 = _mm256_max_pd(hi1, x1);
+	}
+
+	double lo[4], hi[4], unused;
+	_mm256_storeu_pd(lo, _mm256_min_pd(lo0, lo1));
+	_mm256_storeu_pd(hi, _mm256_max_pd(hi0, hi1));
+	minmax_scalar(lo, 4, min, &unused);
+	minmax_scalar(hi, 4, &unused, max);
+	for (; i < n; i++) {
+		if (a[i] < *min) *min = a[i];
+		if (a[i] > *max) *max = a[i];
+	}
+}
+
+#endif
+
+typedef struct {
+	const char *name;
+	double (*sum)(const double *, size_t);
+	double (*sqdev)(const double *, size_t, double);
+	void (*minmax)(const double *, size_t, double *, double *);
+} kernels_t;
+
+static const kernels_t kernels[] = {
+#ifdef HAVE_X86
+	{ "avx2", sum_avx2, sqdev_avx2, minmax_avx2 },
+	{ "sse2", sum_sse2, sqdev_sse2, minmax_sse2 },
+#endif
+	{ "scalar", sum_scalar, sqdev_scalar, minmax_scalar },
+};
+
+static const kernels_t *active = 0;
+
+/**
+ * Whether the CPU can run a kernel set
+ */
+static int supported(const kernels_t *k) {
+#ifdef HAVE_X86
+	__builtin_cpu_init();
+	if (strcmp(k->name, "avx2") == 0) return __builtin_cpu_supports("avx2");
+	if (strcmp(k->name, "sse2") == 0) return __builtin_cpu_supports("sse2");
+#endif
+	return strcmp(k->name, "scalar") == 0;
+}
+
+/**
+ * Returns the kernel set in use, picking the fastest supported one on
+ * the first call
+ */
+static const kernels_t *pick() {
+	if (!active) {
+		const kernels_t *k = kernels;
+		while (!supported(k)) k++;
+		active = k;
+	}
+	return active;
+}
+
+/**
+ * Forces a kernel set, for benchmarking
+ *
+ * @param isa "avx2", "sse2" or "scalar"
+ * @return 0 on success, -1 if the CPU or build does not support it
+ */
+int reduce_select(const char *isa) {
+	for (size_t i = 0; i < sizeof(kernels)/sizeof(kernels[0]); i++) {
+		if (strcmp(kernels[i].name, isa) == 0 && supported(&kernels[i])) {
+			active = &kernels[i];
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @return the name of the kernel set in use
+ */
+const char *reduce_isa() {
+	return pick()->name;
+}
+
+/**
+ * Sums an array
+ *
+ * @param a the array
+ * @param n the size of the array
+ * @return the sum
+ */
+double reduce_sum(const double *a, size_t n) {
+	return pick()->sum(a, n);
+}
+
+/**
+ * Sums squared deviations from mean
+ *
+ * @param a the array
+ * @param n the size of the array
+ * @param mean the value to measure deviations from
+ * @return the sum of (a[i] - mean)^2
+ */
+double reduce_sqdev(const double *a, size_t n, double mean) {
+	return pick()->sqdev(a, n, mean);
+}
+
+/**
+ * Finds the smallest and largest values
+ *
+ * @param a the array
+ * @param n the size of the array, > 0
+ * @param min the minimum to "return"
+ * @param max the maximum to "return"
+ */
+void reduce_minmax(const double *a, size_t n, double *min, double *max) {
+	pick()->minmax(a, n, min, max);
+}
@@ -0,0 +1,50 @@
+#ifndef _REDUCE_H_
+#define _REDUCE_H_
+/*
+ * Vectorized reductions over arrays of doubles for lab 5.
+ *
+ * Each kernel has AVX2, SSE2 and plain C versions; the first call picks
+ * the best one the CPU supports. Sums keep several vector accumulators
+ * with Kahan compensation in every lane, so they are both faster and
+ * more accurate than a simple loop.
+ */
+
+#include <stddef.h>
+
+/*
+ * @param a the array
+ * @param n the size of the array
+ * @return the sum of the values
+ */
+double reduce_sum(const double *a, size_t n);
+
+/*
+ * @param a the array
+ * @param n the size of the array
+ * @param mean the value to measure deviations from
+ * @return the sum of (a[i] - mean)^2
+ */
+double reduce_sqdev(const double *a, size_t n, double mean);
+
+/*
+ * finds the smallest and largest values
+ * @param a the array
+ * @param n the size of the array, > 0
+ * @param min the minimum to "return"
+ * @param max the maximum to "return"
+ */
+void reduce_minmax(const double *a, size_t n, double *min, double *max);
+
+/*
+ * forces a kernel set, for benchmarking
+ * @param isa "avx2", "sse2" or "scalar"
+ * @return 0 on success, -1 if the CPU or build does not support it
+ */
+int reduce_select(const char *isa);
+
+/*
+ * @return the name of the kernel set in use
+ */
+const char *reduce_isa();
+
+#endif
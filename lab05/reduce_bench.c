@@ -0,0 +1,133 @@
+/*
+ * reduce_bench.c
+ *
+ * Times the reduction kernels in reduce.c against the original scalar
+ * sum() and stddev() loops from stats.c, for array sizes from 10^6 up
+ * to a limit (default 10^8; 10^9 needs 8 GB).
+ *
+ *   ./reduce-bench [max_values]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "reduce.h"
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/* The loops reduce.c replaced */
+
+static double old_sum(int size, double *arr) {
+	double sum = 0;
+	for (int i = 0; i < size; i++) {
+		sum += arr[i];
+	}
+	return sum;
+}
+
+static double old_sqdev(int size, double mean, double *arr) {
+	double msd = 0;
+	for (int i = 0; i < size; i++) {
+		msd += pow(arr[i] - mean, 2.0);
+	}
+	return msd;
+}
+
+/**
+ * Reference sum in long double with Kahan compensation
+ */
+static long double ref_sum(const double *a, size_t n) {
+	long double s = 0, c = 0;
+	for (size_t i = 0; i < n; i++) {
+		long double y = a[i] - c;
+		long double t = s + y;
+		c = (t - s) - y;
+		s = t;
+	}
+	return s;
+}
+
+static long double ref_sqdev(const double *a, size_t n, long double mean) {
+	long double s = 0;
+	for (size_t i = 0; i < n; i++) {
+		s += (a[i] - mean)*(a[i] - mean);
+	}
+	return s;
+}
+
+static void report(const char *name, double secs, size_t n, double got, long double want) {
+	double err = want == 0 ? 0 : (double)fabsl((got - want)/want);
+	printf("  %-14s %8.3f ms %7.3f ns/value  rel err %.2e\n",
+			name, secs*1e3, secs*1e9/n, err);
+}
+
+int main(int argc, char *argv[]) {
+	size_t max = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+	const char *isas[] = { "avx2", "sse2", "scalar" };
+
+	double *a = malloc(sizeof(double)*max);
+	if (!a) {
+		fprintf(stderr, "Cannot allocate %zu values\n", max);
+		return 1;
+	}
+	/* a large offset plus small noise, where naive sums lose digits */
+	srand(280);
+	for (size_t i = 0; i < max; i++) {
+		a[i] = 1e6 + rand()/(double)RAND_MAX;
+	}
+
+	for (size_t n = 1000000; n <= max; n *= 10) {
+		printf("n = %zu\n", n);
+		long double want_sum = ref_sum(a, n);
+		double mean = want_sum/n;
+		double t, got;
+
+		t = now();
+		got = old_sum(n, a);
+		report("sum (old)", now() - t, n, got, want_sum);
+		for (int i = 0; i < 3; i++) {
+			if (reduce_select(isas[i]) == 0) {
+				char name[32];
+				snprintf(name, sizeof(name), "sum %s", isas[i]);
+				t = now();
+				got = reduce_sum(a, n);
+				report(name, now() - t, n, got, want_sum);
+			}
+		}
+
+		long double want_sq = ref_sqdev(a, n, mean);
+		t = now();
+		got = old_sqdev(n, mean, a);
+		report("sqdev (old)", now() - t, n, got, want_sq);
+		for (int i = 0; i < 3; i++) {
+			if (reduce_select(isas[i]) == 0) {
+				char name[32];
+				snprintf(name, sizeof(name), "sqdev %s", isas[i]);
+				t = now();
+				got = reduce_sqdev(a, n, mean);
+				report(name, now() - t, n, got, want_sq);
+			}
+		}
+
+		for (int i = 0; i < 3; i++) {
+			if (reduce_select(isas[i]) == 0) {
+				char name[32];
+				double lo, hi;
+				snprintf(name, sizeof(name), "minmax %s", isas[i]);
+				t = now();
+				reduce_minmax(a, n, &lo, &hi);
+				report(name, now() - t, n, 0, 0);
+			}
+		}
+	}
+
+	free(a);
+	return 0;
+}
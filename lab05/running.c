@@ -0,0 +1,78 @@
+/*
+ * running.c
+ *
+ * Constant-memory running statistics. See running.h.
+ */
+
+#include <math.h>
+#include "running.h"
+
+/**
+ * Initializes an empty accumulator
+ *
+ * @param a the accumulator
+ */
+void accum_init(accum_t *a) {
+	a->count = 0;
+	a->mean = 0;
+	a->m2 = 0;
+	a->min = INFINITY;
+	a->max = -INFINITY;
+}
+
+/**
+ * Adds a value to an accumulator
+ *
+ * @param a the accumulator
+ * @param x the value
+ */
+void accum_add(accum_t *a, double x) {
+	double delta = x - a->mean;
+	a->count++;
+	a->mean += delta/a->count;
+	a->m2 += delta*(x - a->mean);
+	if (x < a->min) a->min = x;
+	if (x > a->max) a->max = x;
+}
+
+/**
+ * Merges b into a (Chan et al.'s pairwise update)
+ *
+ * @param a the accumulator to update
+ * @param b the accumulator to merge in
+ */
+void accum_merge(accum_t *a, const accum_t *b) {
+	if (b->count == 0) return;
+	if (a->count == 0) {
+		*a = *b;
+		return;
+	}
+
+	long n = a->count + b->count;
+	double delta = b->mean - a->mean;
+	a->m2 += b->m2 + delta*delta*((double)a->count*b->count/n);
+	a->mean += delta*b->count/n;
+	a->count = n;
+	if (b->min < a->min) a->min = b->min;
+	if (b->max > a->max) a->max = b->max;
+}
+
+/**
+ * Finds the sample variance
+ *
+ * @param a the accumulator
+ * @return the variance
+ */
+double accum_variance(const accum_t *a) {
+	return a->m2/(a->count*1.0 - 1.0);
+}
+
+/**
+ * Finds the sample standard deviation
+ *
+ * @param a the accumulator
+ * @return the standard deviation
+ */
+double accum_stddev(const accum_t *a) {
+	return sqrt(accum_variance(a));
+}
@@ -0,0 +1,52 @@
+#ifndef _RUNNING_H_
+#define _RUNNING_H_
+/*
+ * Constant-memory running statistics for lab 5.
+ *
+ * accum_t keeps count, mean, min, max and the sum of squared deviations
+ * (M2) using Welford's update, which stays accurate where the naive
+ * sum-of-squares formula cancels catastrophically. Two accumulators can
+ * be merged, so partial results from different inputs combine exactly.
+ */
+
+typedef struct {
+	long count;
+	double mean;
+	double m2;
+	double min;
+	double max;
+} accum_t;
+
+/*
+ * initializes an empty accumulator
+ * @param a the accumulator
+ */
+void accum_init(accum_t *a);
+
+/*
+ * adds a value to an accumulator
+ * @param a the accumulator
+ * @param x the value
+ */
+void accum_add(accum_t *a, double x);
+
+/*
+ * merges b into a, as if every value added to b had been added to a
+ * @param a the accumulator to update
+ * @param b the accumulator to merge in
+ */
+void accum_merge(accum_t *a, const accum_t *b);
+
+/*
+ * @param a the accumulator
+ * @return the sample variance (n - 1 denominator)
+ */
+double accum_variance(const accum_t *a);
+
+/*
+ * @param a the accumulator
+ * @return the sample standard deviation
+ */
+double accum_stddev(const accum_t *a);
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ * select.c
+ *
+ * Selection and sorting for arrays of doubles. See select.h.
+ */
+
+#include "select.h"
+
+/* Ranges this small are finished with insertion sort */
+#define SMALL_RANGE 16
+
+static void swap(double *arr, int i, int j) {
+	double tmp = arr[i];
+	arr[i] = arr[j];
+	arr[j] = tmp;
+}
+
+static int log2i(int n) {
+	int r = 0;
+	while (n >>= 1) r++;
+	return r;
+}
+
+/**
+ * Sorts arr[lo..hi] with insertion sort
+ */
+static void insertion_sort(double *arr, int lo, int hi) {
+	for (int i = lo + 1; i <= hi; i++) {
+		double x = arr[i];
+		int j = i - 1;
+		while (j >= lo && arr[j] > x) {
+			arr[j + 1] = arr[j];
+			j--;
+		}
+		arr[j + 1] = x;
+	}
+}
+
+/**
+ * Restores the max-heap property below node i of the heap arr[lo..lo+n)
+ */
+static void sift_down(double *arr, int lo, int i, int n) {
+	double x = arr[lo + i];
+	int child;
+	while ((child = 2*i + 1) < n) {
+		if (child + 1 < n && arr[lo + child + 1] > arr[lo + child]) child++;
+		if (arr[lo + child] <= x) break;
+		arr[lo + i] = arr[lo + child];
+		i = child;
+	}
+	arr[lo + i] = x;
+}
+
+/**
+ * Sorts arr[lo..hi] with heapsort (the introsort fallback)
+ */
+static void heap_sort(double *arr, int lo, int hi) {
+	int n = hi - lo + 1;
+	for (int i = n/2 - 1; i >= 0; i--) {
+		sift_down(arr, lo, i, n);
+	}
+	for (int end = n - 1; end > 0; end--) {
+		swap(arr, lo, lo + end);
+		sift_down(arr, lo, 0, end);
+	}
+}
+
+/**
+ * Partitions arr[lo..hi] around the median of its first, middle and
+ * last values
+ *
+ * @return p such that arr[lo..p] <= pivot <= arr[p+1..hi]
+ */
+static int partition(double *arr, int lo, int hi) {
+	int mid = lo + (hi - lo)/2;
+
+	/* order lo, mid, hi so that arr[mid] is the median of three */
+	if (arr[mid] < arr[lo]) swap(arr, mid, lo);
+	if (arr[hi] < arr[lo]) swap(arr, hi, lo);
+	if (arr[hi] < arr[mid]) swap(arr, hi, mid);
+	double pivot = arr[mid];
+
+	/* Hoare partition: equal keys split evenly between the sides */
+	int i = lo - 1, j = hi + 1;
+	while (1) {
+		do i++; while (arr[i] < pivot);
+		do j--; while (arr[j] > pivot);
+		if (i >= j) return j;
+		swap(arr, i, j);
+	}
+}
+
+/**
+ * Finds the k-th smallest value (quickselect, falling back to a full
+ * sort of the remaining range if partitioning keeps going badly)
+ *
+ * @param arr the array
+ * @param size the size of the array
+ * @param k 0-based rank
+ * @return the k-th smallest value
+ */
+double select_kth(double *arr, int size, int k) {
+	int lo = 0, hi = size - 1;
+	int budget = 2*log2i(size) + 4;
+
+	while (hi - lo >= SMALL_RANGE) {
+		if (budget-- == 0) {
+			heap_sort(arr, lo, hi);
+			return arr[k];
+		}
+		int p = partition(arr, lo, hi);
+		if (k <= p) {
+			hi = p;
+		} else {
+			lo = p + 1;
+		}
+	}
+	insertion_sort(arr, lo, hi);
+	return arr[k];
+}
+
+/**
+ * Finds a quantile by linear interpolation between ranks
+ *
+ * @param arr the array
+ * @param size the size of the array
+ * @param q the quantile
+ * @return the quantile
+ */
+double quantile(double *arr, int size, double q) {
+	double pos = q*(size - 1);
+	int k = (int)pos;
+	double lo = select_kth(arr, size, k);
+
+	if (k + 1 >= size || pos == k) {
+		return lo;
+	}
+
+	/* select_kth left everything after k >= arr[k]; the next rank is
+	   the smallest of those */
+	double hi = arr[k + 1];
+	for (int i = k + 2; i < size; i++) {
+		if (arr[i] < hi) hi = arr[i];
+	}
+	return lo + (pos - k)*(hi - lo);
+}
+
+static void introsort_range(double *arr, int lo, int hi, int depth) {
+	while (hi - lo >= SMALL_RANGE) {
+		if (depth-- == 0) {
+			heap_sort(arr, lo, hi);
+			return;
+		}
+		int p = partition(arr, lo, hi);
+		/* recurse into the smaller side to bound stack depth */
+		if (p - lo < hi - p) {
+			introsort_range(arr, lo, p, depth);
+			lo = p + 1;
+		} else {
+			introsort_range(arr, p + 1, hi, depth);
+			hi = p;
+		}
+	}
+	insertion_sort(arr, lo, hi);
+}
+
+/**
+ * Sorts an array in place (introsort)
+ *
+ * @param arr the array
+ * @param size the size of the array
+ */
+void introsort(double *arr, int size) {
+	if (size > 1) {
+		introsort_range(arr, 0, size - 1, 2*log2i(size));
+	}
+}
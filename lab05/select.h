@@ -0,0 +1,38 @@
+#ifndef _SELECT_H_
+#define _SELECT_H_
+/*
+ * Order statistics on arrays of doubles for lab 5.
+ *
+ * select_kth() and quantile() run in expected linear time and only
+ * partially reorder the array. introsort() is an O(n log n) worst-case
+ * sort for when every value is needed in order.
+ */
+
+/*
+ * finds the k-th smallest value, leaving it at arr[k] with smaller
+ * values before it and larger values after it
+ * @param arr the array (reordered)
+ * @param size the size of the array
+ * @param k 0-based rank, 0 <= k < size
+ * @return the k-th smallest value
+ */
+double select_kth(double *arr, int size, int k);
+
+/*
+ * finds a quantile, interpolating linearly between the two closest
+ * ranks (so q = 0.5 gives the usual median)
+ * @param arr the array (reordered)
+ * @param size the size of the array, > 0
+ * @param q the quantile, 0 <= q <= 1
+ * @return the quantile
+ */
+double quantile(double *arr, int size, double q);
+
+/*
+ * sorts an array in place
+ * @param arr the array
+ * @param size the size of the array
+ */
+void introsort(double *arr, int size);
+
+#endif
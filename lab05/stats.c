@@ -6,30 +6,183 @@
  *
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
 #include "readfile.h"
+#include "running.h"
+#include "select.h"
+#include "tdigest.h"
+#include "parallel.h"
+#include "dbuf.h"
+#include "reduce.h"
+#include "group.h"
+#include "window.h"
+#include "hist.h"
+
+/* Maximum number of -q quantiles */
+#define MAX_QUANTILES 64
+
+/* With more quantiles than this, one sort beats repeated selection */
+#define SORT_THRESHOLD 8
+
+/* Bytes sampled from the start of a file to estimate its value count */
+#define SAMPLE_BYTES (1 << 16)
 
-double *getValues(int *size, int *capacity, char *filename);
-double *new_array(int *capacity, double *arr);
+/* Bytes read from stdin at a time in window mode */
+#define WINDOW_READ (1 << 16)
+
+/* Most rows in a printed histogram, and the width of its bars */
+#define HIST_ROWS 40
+#define HIST_BAR 40
+
+int getValues(dbuf_t *values, char *filename);
+size_t estimateValues(char *filename);
 double mean(int size, double *arr);
 double median(int size, double *arr);
 double stddev(int size, double mean, double *arr);
 void sort(int size, double *arr);
+int streamStats(char *filename, double compression, double *qs, int num_qs);
+int parallelStats(char *filename, int threads, double compression, double *qs, int num_qs);
+void printStream(accum_t *acc, tdigest_t *sketch, double *qs, int num_qs);
+int groupStats(char **files, int num_files, int keyed, int threads, double compression, double *qs, int num_qs);
+int windowStats(size_t max_count, double max_age, double interval, double *qs, int num_qs);
+int histStats(char *filename, double *qs, int num_qs);
+void printHistogram(hist_t *h);
+int parseQuantiles(char *list, double *qs);
+double sortedQuantile(int size, double *arr, double q);
+
+/**
+ * Prints usage and exits
+ *
+ * @param cmd the program name
+ */
+static void usage(char *cmd) {
+	printf("usage: %s [-sSH] [-j threads] [-c compression] [-q q1,q2,...] filename\n", cmd);
+	printf("       %s [-g] [-j threads] [-c compression] [-q q1,q2,...] filename...\n", cmd);
+	printf("  -s  streaming mode: one pass in bounded memory, approximate quantiles\n");
+	printf("  -H  histogram mode: one pass into log-linear buckets (positive values)\n");
+	printf("  -j  streaming mode split across threads (0 for one per CPU)\n");
+	printf("  -g  group mode: lines are \"key value\", one summary row per key\n");
+	printf("      (with several files and no -g, one row per file)\n");
+	printf("       %s -w count|-T seconds [-i seconds] [-q q1,q2,...]\n", cmd);
+	printf("  -w  window mode: read stdin until it closes, reporting on the last\n");
+	printf("      count values (-w) and/or the values from the last seconds (-T)\n");
+	printf("  -i  seconds between window reports (default 1)\n");
+	printf("  -c  quantile sketch accuracy/memory tradeoff (default %d)\n", TDIGEST_DEFAULT_COMPRESSION);
+	printf("  -q  also print the given quantiles (0 to 1)\n");
+	printf("  -S  also print every value in sorted order\n");
+	exit(1);
+}
 
 int main(int argc, char *argv[]) {
-	if(argc != 2) {
-		printf("argc != 2\n");
-		printf ("usage: ./stats filename\n");
-		exit(1);
+	int streaming = 0;
+	int histogram = 0;
+	int keyed = 0;
+	long window_count = 0;
+	double window_age = 0;
+	double interval = 1;
+	int threads = -1;
+	int print_sorted = 0;
+	double qs[MAX_QUANTILES];
+	int num_qs = 0;
+	double compression = TDIGEST_DEFAULT_COMPRESSION;
+	int c;
+
+	while ((c = getopt(argc, argv, "sSHgj:c:q:w:T:i:")) != -1) {
+		switch (c) {
+		case 's':
+			streaming = 1;
+			break;
+		case 'H':
+			histogram = 1;
+			break;
+		case 'g':
+			keyed = 1;
+			break;
+		case 'w':
+			window_count = atol(optarg);
+			if (window_count <= 0) {
+				usage(argv[0]);
+			}
+			break;
+		case 'T':
+			window_age = atof(optarg);
+			if (window_age <= 0) {
+				usage(argv[0]);
+			}
+			break;
+		case 'i':
+			interval = atof(optarg);
+			if (interval <= 0) {
+				usage(argv[0]);
+			}
+			break;
+		case 'j':
+			threads = atoi(optarg);
+			if (threads < 0) {
+				usage(argv[0]);
+			}
+			break;
+		case 'S':
+			print_sorted = 1;
+			break;
+		case 'c':
+			compression = atof(optarg);
+			if (compression < 10) {
+				usage(argv[0]);
+			}
+			break;
+		case 'q':
+			num_qs = parseQuantiles(optarg, qs);
+			if (num_qs < 0) {
+				usage(argv[0]);
+			}
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (window_count > 0 || window_age > 0) {
+		if (optind != argc) {
+			usage(argv[0]);
+		}
+		return windowStats(window_count, window_age, interval, qs, num_qs);
+	}
+	if (optind >= argc) {
+		usage(argv[0]);
+	}
+	if (keyed || argc - optind > 1) {
+		return groupStats(&argv[optind], argc - optind, keyed, threads < 0 ? 0 : threads,
+				compression, qs, num_qs);
+	}
+	char *filename = argv[optind];
+
+	if (histogram) {
+		return histStats(filename, qs, num_qs);
+	}
+	if (threads >= 0) {
+		return parallelStats(filename, threads, compression, qs, num_qs);
+	}
+	if (streaming) {
+		return streamStats(filename, compression, qs, num_qs);
 	}
 	
-	int size = 0;
-	int capacity = 20;
-	double *arr = getValues(&size, &capacity, argv[1]);
-	sort(size, arr);
+	dbuf_t values;
+	if (getValues(&values, filename) == -1) {
+		exit(1);
+	}
+	int size = values.size;
+	double *arr = values.data;
 
 	printf("\nStatistics:\n");
 	printf("--------\n");
@@ -44,54 +197,530 @@ int main(int argc, char *argv[]) {
 	double sd = stddev(size, m, arr);
 	printf("stddev:\t\t%f\n", sd);
 
-	printf("\nUnused array slots: %i\n", capacity - size);
+	if (size > 0) {
+		double lo, hi;
+		reduce_minmax(arr, size, &lo, &hi);
+		printf("min:\t\t%f\n", lo);
+		printf("max:\t\t%f\n", hi);
+	}
+
+	/* Only sort when every value is wanted in order or enough
+	   quantiles are asked for that selection would cost more */
+	int sorted = print_sorted || num_qs > SORT_THRESHOLD;
+	if (sorted) {
+		sort(size, arr);
+	}
+	for (int i = 0; i < num_qs && size > 0; i++) {
+		double q = sorted ? sortedQuantile(size, arr, qs[i]) : quantile(arr, size, qs[i]);
+		printf("q%g:\t\t%f\n", qs[i], q);
+	}
+	if (print_sorted) {
+		printf("\nSorted values:\n");
+		for (int i = 0; i < size; i++) {
+			printf("%f\n", arr[i]);
+		}
+	}
+
+	printf("\nUnused array slots: %zu\n", values.capacity - values.size);
 	
-	free(arr);
+	dbuf_free(&values);
 }
 
-/** 
- * Gets the values from a file
- * @param size Pointer to the size of the array
- * @param capacity Pointer to the capacity of the arry
+/**
+ * Parses a comma separated list of quantiles
+ *
+ * @param list the list, e.g. "0.5,0.9,0.99"
+ * @param qs array of MAX_QUANTILES to fill
+ * @return the number of quantiles, -1 if the list is invalid
+ */
+int parseQuantiles(char *list, double *qs) {
+	int n = 0;
+	char *endp;
+
+	while (n < MAX_QUANTILES) {
+		qs[n] = strtod(list, &endp);
+		if (endp == list || qs[n] < 0 || qs[n] > 1 || (*endp != ',' && *endp != '\0')) {
+			return -1;
+		}
+		n++;
+		if (*endp == '\0') {
+			return n;
+		}
+		list = endp + 1;
+	}
+
+	return -1;
+}
+
+/**
+ * Prints the quantile sketch lines of the report
+ *
+ * @param t the sketch
+ * @param qs the quantiles asked for with -q
+ * @param num_qs the number of quantiles
+ */
+void printSketch(tdigest_t *t, double *qs, int num_qs) {
+	printf("p50:\t\t%f\n", tdigest_quantile(t, 0.5));
+	printf("p90:\t\t%f\n", tdigest_quantile(t, 0.9));
+	printf("p99:\t\t%f\n", tdigest_quantile(t, 0.99));
+	printf("p999:\t\t%f\n", tdigest_quantile(t, 0.999));
+	for (int i = 0; i < num_qs; i++) {
+		printf("q%g:\t\t%f (approx)\n", qs[i], tdigest_quantile(t, qs[i]));
+	}
+	printf("\nSketch centroids: %i (compression %g)\n", tdigest_compress(t), t->compression);
+}
+
+/**
+ * Prints the streaming report
+ *
+ * @param acc the running statistics
+ * @param sketch the quantile sketch
+ * @param qs the quantiles asked for with -q
+ * @param num_qs the number of quantiles
+ */
+void printStream(accum_t *acc, tdigest_t *sketch, double *qs, int num_qs) {
+	printf("\nStatistics:\n");
+	printf("--------\n");
+	printf("num values:\t%li\n", acc->count);
+	printf("mean:\t\t%f\n", acc->mean);
+	printf("median:\t\t%f (approx)\n", tdigest_quantile(sketch, 0.5));
+	printf("stddev:\t\t%f\n", accum_stddev(acc));
+	printf("min:\t\t%f\n", acc->min);
+	printf("max:\t\t%f\n", acc->max);
+	printSketch(sketch, qs, num_qs);
+}
+
+/**
+ * Computes and prints statistics in a single pass over a file without
+ * storing the values. The median and percentiles come from a t-digest.
+ *
  * @param filename string representing the file name
- * @return The array of double values
- */
-double *getValues(int *size, int *capacity, char *filename) {
-	if (openFile(filename) != -1) {
-		double *arr = malloc(sizeof(double)*(*capacity));
-		while (readDouble(&arr[*size]) == 0) {
-			if (*size == *capacity - 1) {
-				arr = new_array(capacity, arr);
+ * @param compression the t-digest compression
+ * @param qs the quantiles asked for with -q
+ * @param num_qs the number of quantiles
+ * @return 0 on success, 1 if the file cannot be opened
+ */
+int streamStats(char *filename, double compression, double *qs, int num_qs) {
+	accum_t acc;
+	double x;
+
+	if (openFile(filename) == -1) {
+		fprintf(stderr, "There was an error opening the file: %s\n", filename);
+		return 1;
+	}
+
+	tdigest_t *sketch = tdigest_new(compression);
+	accum_init(&acc);
+	while (readDouble(&x) == 0) {
+		accum_add(&acc, x);
+		tdigest_add(sketch, x);
+	}
+	closeFile();
+
+	printStream(&acc, sketch, qs, num_qs);
+	tdigest_free(sketch);
+	return 0;
+}
+
+/**
+ * Computes statistics per group and prints them as tab separated rows
+ * under a header line, sorted by group. The median and quantiles come
+ * from each group's t-digest.
+ *
+ * @param files the file names
+ * @param num_files the number of files
+ * @param keyed whether lines are "key value" pairs rather than values
+ *              grouped by file
+ * @param threads the number of threads, 0 for one per CPU
+ * @param compression the t-digest compression
+ * @param qs the quantile columns, p50/p90/p99 if there are none
+ * @param num_qs the number of quantiles
+ * @return 0 on success, 1 if any file cannot be read
+ */
+int groupStats(char **files, int num_files, int keyed, int threads, double compression, double *qs, int num_qs) {
+	double default_qs[] = { 0.5, 0.9, 0.99 };
+	long invalid;
+
+	if (num_qs == 0) {
+		qs = default_qs;
+		num_qs = 3;
+	}
+
+	group_table_t *table = group_table_new(compression);
+	int failed = groupFiles(files, num_files, keyed, threads, table, &invalid);
+	if (invalid > 0) {
+		fprintf(stderr, "Skipped %li invalid values\n", invalid);
+	}
+
+	printf("group\tcount\tmean\tstddev\tmin\tmax");
+	for (int i = 0; i < num_qs; i++) {
+		printf("\tp%g", qs[i]*100);
+	}
+	printf("\n");
+
+	group_t **groups = group_sorted(table);
+	for (size_t i = 0; i < table->count; i++) {
+		group_t *g = groups[i];
+		/* One value has no spread, rather than a sample stddev of 0/0 */
+		double sd = g->acc.count < 2 ? 0 : accum_stddev(&g->acc);
+		printf("%s\t%li\t%f\t%f\t%f\t%f", g->key, g->acc.count, g->acc.mean,
+				sd, g->acc.min, g->acc.max);
+		for (int j = 0; j < num_qs; j++) {
+			printf("\t%f", tdigest_quantile(g->sketch, qs[j]));
+		}
+		printf("\n");
+	}
+
+	free(groups);
+	group_table_free(table);
+	return failed > 0;
+}
+
+/**
+ * Prints a histogram as rows of value ranges with counts and bars. Only
+ * powers of two holding values are shown, each split into as many rows
+ * as fit in HIST_ROWS.
+ *
+ * @param h the histogram
+ */
+void printHistogram(hist_t *h) {
+	long per_binade = 1L << h->sub_bits;
+	long binades = h->num_buckets/per_binade;
+	long used = 0;
+	long biggest = 1;
+
+	for (long b = 0; b < binades; b++) {
+		for (long i = b*per_binade; i < (b + 1)*per_binade; i++) {
+			if (h->counts[i] > 0) {
+				used++;
+				break;
 			}
-			(*size)++;
 		}
-		closeFile(filename);
-		return arr;
-	} else {
+	}
+	long rows = per_binade;
+	while (rows > 1 && used*rows > HIST_ROWS) {
+		rows /= 2;
+	}
+	long span = per_binade/rows;
+
+	for (long i = 0; i < h->num_buckets; i += span) {
+		long n = 0;
+		for (long j = i; j < i + span; j++) n += h->counts[j];
+		if (n > biggest) biggest = n;
+	}
+
+	printf("\nHistogram:\n");
+	if (h->below > 0) {
+		printf("%12s %12g %10li %6.2f%%\n", "below", hist_bucket_low(h, 0), h->below,
+				100.0*h->below/h->total);
+	}
+	long cum = h->below;
+	for (long b = 0; b < binades; b++) {
+		long n_binade = 0;
+		for (long i = b*per_binade; i < (b + 1)*per_binade; i++) n_binade += h->counts[i];
+		if (n_binade == 0) {
+			continue;
+		}
+
+		for (long i = b*per_binade; i < (b + 1)*per_binade; i += span) {
+			long n = 0;
+			for (long j = i; j < i + span; j++) n += h->counts[j];
+			cum += n;
+			printf("%12g %12g %10li %6.2f%% ", hist_bucket_low(h, i), hist_bucket_low(h, i + span),
+					n, 100.0*cum/h->total);
+			for (long k = 0; k < (n*HIST_BAR + biggest - 1)/biggest; k++) putchar('#');
+			printf("\n");
+		}
+	}
+	if (h->above > 0) {
+		printf("%12g %12s %10li %6.2f%%\n", hist_bucket_low(h, h->num_buckets), "above", h->above,
+				100.0);
+	}
+}
+
+/**
+ * Computes and prints statistics and a histogram in a single pass over
+ * a file, without storing the values
+ *
+ * @param filename string representing the file name
+ * @param qs the percentiles to print, a default set if there are none
+ * @param num_qs the number of percentiles
+ * @return 0 on success, 1 if the file cannot be opened
+ */
+int histStats(char *filename, double *qs, int num_qs) {
+	double default_qs[] = { 0.5, 0.9, 0.99, 0.999, 0.9999 };
+	accum_t acc;
+	double x;
+
+	if (num_qs == 0) {
+		qs = default_qs;
+		num_qs = 5;
+	}
+	if (openFile(filename) == -1) {
+		fprintf(stderr, "There was an error opening the file: %s\n", filename);
+		return 1;
+	}
+
+	hist_t *h = hist_new(HIST_DEFAULT_SUB_BITS);
+	accum_init(&acc);
+	while (readDouble(&x) == 0) {
+		accum_add(&acc, x);
+		hist_add(h, x);
+	}
+	closeFile();
+
+	printf("\nStatistics:\n");
+	printf("--------\n");
+	printf("num values:\t%li\n", acc.count);
+	printf("mean:\t\t%f\n", acc.mean);
+	printf("stddev:\t\t%f\n", accum_stddev(&acc));
+	printf("min:\t\t%f\n", acc.min);
+	printf("max:\t\t%f\n", acc.max);
+	for (int i = 0; i < num_qs; i++) {
+		printf("p%g:\t\t%f\n", qs[i]*100, hist_quantile(h, qs[i]));
+	}
+	printHistogram(h);
+
+	hist_free(h);
+	return 0;
+}
+
+/**
+ * @return seconds on a monotonic clock
+ */
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/**
+ * Prints one tab separated window report row
+ *
+ * @param w the window
+ * @param elapsed seconds since the start
+ * @param qs the quantile columns
+ * @param num_qs the number of quantiles
+ */
+static void printWindow(window_t *w, double elapsed, double *qs, int num_qs) {
+	printf("%.3f\t%zu\t%f\t%f", elapsed, w->count, w->mean, window_stddev(w));
+	for (int i = 0; i < num_qs; i++) {
+		printf("\t%f", window_quantile(w, qs[i]));
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+/**
+ * Reads numbers from stdin until it closes, keeping statistics over a
+ * sliding window and printing a tab separated row every interval. Input
+ * is read with poll() so rows keep coming while the producer is idle.
+ *
+ * @param max_count the most values in the window, 0 for no limit
+ * @param max_age the oldest value in the window in seconds, 0 for no
+ *                limit
+ * @param interval seconds between rows
+ * @param qs the quantile columns, p50/p90/p99 if there are none
+ * @param num_qs the number of quantiles
+ * @return 0 on success, 1 on a read error
+ */
+int windowStats(size_t max_count, double max_age, double interval, double *qs, int num_qs) {
+	double default_qs[] = { 0.5, 0.9, 0.99 };
+	static char buf[WINDOW_READ + 1];
+	size_t have = 0;
+	long invalid = 0;
+	int status = 0;
+
+	if (num_qs == 0) {
+		qs = default_qs;
+		num_qs = 3;
+	}
+
+	printf("time\tcount\tmean\tstddev");
+	for (int i = 0; i < num_qs; i++) {
+		printf("\tp%g", qs[i]*100);
+	}
+	printf("\n");
+
+	window_t *w = window_new(max_count, max_age);
+	double start = now();
+	double next = start + interval;
+
+	for (;;) {
+		struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+		double t = now();
+		int timeout = t < next ? (int)((next - t)*1000) + 1 : 0;
+		int ready = poll(&pfd, 1, timeout);
+
+		int done = 0;
+		if (ready > 0) {
+			ssize_t n = read(STDIN_FILENO, buf + have, WINDOW_READ - have);
+			if (n < 0 && errno != EINTR) {
+				perror("read");
+				status = 1;
+				done = 1;
+			} else if (n == 0) {
+				done = 1;
+			} else if (n > 0) {
+				have += n;
+			}
+		}
+		t = now();
+
+		/* Parse every complete token; at the end of input the last one
+		   is complete too. A token running to the end of the buffer
+		   may continue in the next read, so it is carried over, unless
+		   it fills the whole buffer and can never be completed */
+		size_t p = 0;
+		buf[have] = '\0';
+		for (;;) {
+			while (p < have && isspace((unsigned char)buf[p])) p++;
+			size_t end = p;
+			while (end < have && !isspace((unsigned char)buf[end])) end++;
+			if (end == p || (end == have && !done && !(p == 0 && have == WINDOW_READ))) {
+				break;
+			}
+
+			double x;
+			if (parseDouble(buf + p, end - p, &x) == (int)(end - p)) {
+				window_add(w, x, t);
+			} else {
+				invalid++;
+			}
+			p = end;
+		}
+		memmove(buf, buf + p, have - p);
+		have -= p;
+
+		if (t >= next || done) {
+			window_expire(w, t);
+			printWindow(w, t - start, qs, num_qs);
+			next += interval;
+			if (next < t) {
+				next = t + interval;
+			}
+		}
+		if (done) {
+			break;
+		}
+	}
+
+	if (invalid > 0) {
+		fprintf(stderr, "Skipped %li invalid values\n", invalid);
+	}
+	window_free(w);
+	return status;
+}
+
+/**
+ * Computes and prints the streaming report using several threads, each
+ * parsing part of the memory-mapped file
+ *
+ * @param filename string representing the file name
+ * @param threads number of threads, 0 for one per CPU
+ * @param compression the t-digest compression
+ * @param qs the quantiles asked for with -q
+ * @param num_qs the number of quantiles
+ * @return 0 on success, 1 if the file cannot be read
+ */
+int parallelStats(char *filename, int threads, double compression, double *qs, int num_qs) {
+	accum_t acc;
+	long invalid;
+
+	tdigest_t *sketch = tdigest_new(compression);
+	accum_init(&acc);
+	if (parallelValues(filename, threads, &acc, sketch, &invalid) == -1) {
 		fprintf(stderr, "There was an error opening the file: %s\n", filename);
-		return NULL;
+		tdigest_free(sketch);
+		return 1;
+	}
+	if (invalid > 0) {
+		fprintf(stderr, "Skipped %li invalid values\n", invalid);
 	}
 
-	return NULL;
+	printStream(&acc, sketch, qs, num_qs);
+	tdigest_free(sketch);
+	return 0;
 }
 
 /**
- * Allocates a new array of capacity (capacity * 20)
+ * Estimates how many values a file holds from its size and the density
+ * of values in its first SAMPLE_BYTES
  *
- * @param capacity pointer to capacity
- * @param arr old array to copy values from
- * @return new array
+ * @param filename string representing the file name
+ * @return the estimate, 0 if there is nothing to go on
  */
-double *new_array(int *capacity, double *arr) {
-	int prev_capacity = *capacity;
-	*capacity *= 20;
-	double *new = malloc(sizeof(double)*(*capacity));
-	for (int i = 0; i < prev_capacity; i++) {
-		new[i] = arr[i];
+size_t estimateValues(char *filename) {
+	static char sample[SAMPLE_BYTES];
+	struct stat st;
+
+	if (stat(filename, &st) == -1 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+		return 0;
+	}
+	FILE *f = fopen(filename, "r");
+	if (!f) {
+		return 0;
 	}
+	size_t n = fread(sample, 1, SAMPLE_BYTES, f);
+	fclose(f);
 
-	free(arr);
-	return new;
+	/* count token starts */
+	size_t tokens = 0;
+	int in_token = 0;
+	for (size_t i = 0; i < n; i++) {
+		int space = isspace((unsigned char)sample[i]);
+		tokens += !space && !in_token;
+		in_token = !space;
+	}
+	if (tokens == 0) {
+		return 0;
+	}
+	if (n == (size_t)st.st_size) {
+		return tokens;
+	}
+	/* a little over, so a slightly denser tail still fits */
+	size_t estimate = (size_t)((double)st.st_size/n*tokens);
+	return estimate + estimate/16;
+}
+
+/** 
+ * Gets the values from a file
+ * @param values the buffer to initialize and fill
+ * @param filename string representing the file name
+ * @return 0 on success, -1 if the file cannot be opened
+ */
+int getValues(dbuf_t *values, char *filename) {
+	if (openFile(filename) == -1) {
+		fprintf(stderr, "There was an error opening the file: %s\n", filename);
+		return -1;
+	}
+
+	if (dbuf_init(values, estimateValues(filename)) == -1) {
+		fprintf(stderr, "Out of memory\n");
+		closeFile();
+		return -1;
+	}
+	for (;;) {
+		if (values->size == values->capacity && dbuf_grow(values) == -1) {
+			fprintf(stderr, "Out of memory\n");
+			dbuf_free(values);
+			closeFile();
+			return -1;
+		}
+		int want = values->capacity - values->size;
+		int got = readDoubles(values->data + values->size, want);
+		values->size += got;
+		if (got < want) {
+			break;
+		}
+	}
+	closeFile();
+
+	/* hand back a badly overestimated preallocation */
+	if (values->capacity - values->size > values->size/8) {
+		dbuf_shrink(values);
+	}
+	return 0;
 }
 
 /**
@@ -102,11 +731,7 @@ double *new_array(int *capacity, double *arr) {
  * @return the sum
  */
 double sum(int size, double *arr) {
-	double sum = 0;
-	for (int i = 0; i < size; i++) {
-		sum += arr[i];
-	}
-	return sum;
+	return reduce_sum(arr, size);
 }
 
 /**
@@ -121,19 +746,35 @@ double mean(int size, double *arr) {
 }
 
 /**
- * Finds the median of an array of values
+ * Finds the median of an array of values by selection, partially
+ * reordering the array
  *
  * @param size the size of the array
  * @param arr the array
  * @return the median
  */
 double median(int size, double *arr) {
-	int mid = size/2;
-	if (size%2 == 0) {
-		return (arr[mid] + arr[mid + 1])/2.0;
-	} else {
-		return arr[mid];
+	if (size == 0) {
+		return NAN;
+	}
+	return quantile(arr, size, 0.5);
+}
+
+/**
+ * Finds a quantile of a sorted array, interpolating like quantile()
+ *
+ * @param size the size of the array
+ * @param arr the sorted array
+ * @param q the quantile
+ * @return the quantile
+ */
+double sortedQuantile(int size, double *arr, double q) {
+	double pos = q*(size - 1);
+	int k = (int)pos;
+	if (k + 1 >= size) {
+		return arr[k];
 	}
+	return arr[k] + (pos - k)*(arr[k + 1] - arr[k]);
 }
 
 /**
@@ -145,31 +786,20 @@ double median(int size, double *arr) {
  * @return the standard deviation
  */
 double stddev(int size, double mean, double *arr) {
-	double msd = 0;
-	for (int i = 0; i < size; i++) {
-		msd += pow(arr[i] - mean, 2.0);
-	}
+	double msd = reduce_sqdev(arr, size, mean);
 	msd /= (size*1.0 - 1.0);
 
 	return sqrt(msd);
 }
 
 /**
- * Sorts an array in place
+ * Sorts an array in place in O(n log n)
  *
  * @param size the size of the array
  * @param arr the array
  */
 void sort(int size, double *arr) {
-	for (int i = 0; i < size; i++) {
-		for (int j = i + 1; j < size; j++) {
-			if (arr[j] < arr[i]) {
-				double tmp = arr[i];
-				arr[i] = arr[j];
-				arr[j] = tmp;
-			}
-		}
-	}
+	introsort(arr, size);
 }
 
 
@@ -0,0 +1,185 @@
+/*
+ * tdigest.c
+ *
+ * Merging t-digest. See tdigest.h.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "tdigest.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * The k1 scale function, mapping a quantile to a centroid index
+ */
+static double scale_k(double q, double compression) {
+	return compression/(2*M_PI)*asin(2*q - 1);
+}
+
+/**
+ * Inverse of scale_k
+ */
+static double scale_q(double k, double compression) {
+	if (k >= compression/4) return 1;
+	return (sin(k*2*M_PI/compression) + 1)/2;
+}
+
+static int compare_centroids(const void *a, const void *b) {
+	double ma = ((const centroid_t *)a)->mean;
+	double mb = ((const centroid_t *)b)->mean;
+	return (ma > mb) - (ma < mb);
+}
+
+/**
+ * Appends a weighted value to the unmerged buffer, compressing first
+ * if the buffer is full
+ */
+static void add_weighted(tdigest_t *t, double mean, double weight) {
+	if (t->num_merged + t->num_unmerged == t->capacity) {
+		tdigest_compress(t);
+	}
+	t->c[t->num_merged + t->num_unmerged].mean = mean;
+	t->c[t->num_merged + t->num_unmerged].weight = weight;
+	t->num_unmerged++;
+	t->total += weight;
+	if (mean < t->min) t->min = mean;
+	if (mean > t->max) t->max = mean;
+}
+
+/**
+ * Creates an empty digest
+ *
+ * @param compression accuracy/memory parameter
+ * @return the digest
+ */
+tdigest_t *tdigest_new(double compression) {
+	tdigest_t *t = malloc(sizeof(tdigest_t));
+	t->compression = compression;
+	/* room for ~compression centroids plus a buffer several times
+	   larger, so sorting is amortized over many adds */
+	t->capacity = (int)ceil(compression)*6 + 10;
+	t->c = malloc(sizeof(centroid_t)*t->capacity);
+	t->num_merged = 0;
+	t->num_unmerged = 0;
+	t->total = 0;
+	t->min = INFINITY;
+	t->max = -INFINITY;
+	return t;
+}
+
+/**
+ * Frees a digest
+ *
+ * @param t the digest
+ */
+void tdigest_free(tdigest_t *t) {
+	free(t->c);
+	free(t);
+}
+
+/**
+ * Adds a value
+ *
+ * @param t the digest
+ * @param x the value
+ */
+void tdigest_add(tdigest_t *t, double x) {
+	if (!isnan(x)) {
+		add_weighted(t, x, 1);
+	}
+}
+
+/**
+ * Adds every value summarized by other to t
+ *
+ * @param t the digest to update
+ * @param other the digest to merge in
+ */
+void tdigest_merge(tdigest_t *t, const tdigest_t *other) {
+	int n = other->num_merged + other->num_unmerged;
+	for (int i = 0; i < n; i++) {
+		add_weighted(t, other->c[i].mean, other->c[i].weight);
+	}
+	/* the centroid means lie inside [min, max], which may be wider */
+	if (other->min < t->min) t->min = other->min;
+	if (other->max > t->max) t->max = other->max;
+}
+
+/**
+ * Merges buffered values into the centroids
+ *
+ * @param t the digest
+ * @return the number of centroids
+ */
+int tdigest_compress(tdigest_t *t) {
+	int n = t->num_merged + t->num_unmerged;
+	if (t->num_unmerged == 0) {
+		return t->num_merged;
+	}
+
+	qsort(t->c, n, sizeof(centroid_t), compare_centroids);
+
+	/* Sweep in mean order, folding each item into the current
+	   centroid while the centroid stays within one unit of k */
+	int out = 0;
+	double so_far = 0;
+	double limit = t->total*scale_q(scale_k(0, t->compression) + 1, t->compression);
+
+	for (int i = 1; i < n; i++) {
+		centroid_t *cur = &t->c[out];
+		double proposed = cur->weight + t->c[i].weight;
+
+		if (so_far + proposed <= limit) {
+			cur->mean += (t->c[i].mean - cur->mean)*t->c[i].weight/proposed;
+			cur->weight = proposed;
+		} else {
+			so_far += cur->weight;
+			limit = t->total*scale_q(scale_k(so_far/t->total, t->compression) + 1, t->compression);
+			t->c[++out] = t->c[i];
+		}
+	}
+
+	t->num_merged = out + 1;
+	t->num_unmerged = 0;
+	return t->num_merged;
+}
+
+/**
+ * Estimates a quantile by interpolating between centroid centers
+ *
+ * @param t the digest
+ * @param q the quantile
+ * @return the estimate
+ */
+double tdigest_quantile(tdigest_t *t, double q) {
+	tdigest_compress(t);
+	if (t->num_merged == 0) return NAN;
+	if (q <= 0) return t->min;
+	if (q >= 1) return t->max;
+
+	double index = q*t->total;
+	const centroid_t *c = t->c;
+	int n = t->num_merged;
+
+	/* Left of the first center: interpolate from the minimum */
+	if (index < c[0].weight/2) {
+		return t->min + (c[0].mean - t->min)*index/(c[0].weight/2);
+	}
+
+	double center = c[0].weight/2;
+	for (int i = 0; i + 1 < n; i++) {
+		double next = center + (c[i].weight + c[i + 1].weight)/2;
+		if (index < next) {
+			return c[i].mean + (c[i + 1].mean - c[i].mean)*(index - center)/(next - center);
+		}
+		center = next;
+	}
+
+	/* Right of the last center: interpolate to the maximum */
+	double rest = t->total - center;
+	if (rest <= 0) return c[n - 1].mean;
+	return c[n - 1].mean + (t->max - c[n - 1].mean)*(index - center)/rest;
+}
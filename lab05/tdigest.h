@@ -0,0 +1,78 @@
+#ifndef _TDIGEST_H_
+#define _TDIGEST_H_
+/*
+ * A merging t-digest (Dunning) for approximate quantiles in bounded
+ * memory.
+ *
+ * Values are buffered and periodically merged into a sorted list of
+ * centroids (mean, weight). The merge limits each centroid's size
+ * with the k1 scale function, so centroids are small near q = 0 and
+ * q = 1 and the extreme quantiles (p99, p999) stay accurate.
+ *
+ * The compression parameter trades accuracy for memory: a digest
+ * keeps at most about `compression` centroids, and quantile error
+ * shrinks roughly in proportion to 1/compression. Digests built over
+ * different inputs can be merged.
+ */
+
+#define TDIGEST_DEFAULT_COMPRESSION 100
+
+typedef struct {
+	double mean;
+	double weight;
+} centroid_t;
+
+typedef struct {
+	double compression;
+	centroid_t *c;      /* merged centroids, then unmerged values */
+	int num_merged;
+	int num_unmerged;
+	int capacity;
+	double total;       /* total weight */
+	double min;
+	double max;
+} tdigest_t;
+
+/*
+ * creates an empty digest
+ * @param compression accuracy/memory parameter, e.g. 100
+ * @return the digest
+ */
+tdigest_t *tdigest_new(double compression);
+
+/*
+ * frees a digest
+ * @param t the digest
+ */
+void tdigest_free(tdigest_t *t);
+
+/*
+ * adds a value (NaNs are ignored)
+ * @param t the digest
+ * @param x the value
+ */
+void tdigest_add(tdigest_t *t, double x);
+
+/*
+ * adds every value summarized by other to t
+ * @param t the digest to update
+ * @param other the digest to merge in (unchanged)
+ */
+void tdigest_merge(tdigest_t *t, const tdigest_t *other);
+
+/*
+ * estimates a quantile
+ * @param t the digest
+ * @param q the quantile, 0 <= q <= 1
+ * @return the estimate, NAN if the digest is empty
+ */
+double tdigest_quantile(tdigest_t *t, double q);
+
+/*
+ * merges any buffered values into the centroids
+ * @param t the digest
+ * @return the number of centroids
+ */
+int tdigest_compress(tdigest_t *t);
+
+#endif
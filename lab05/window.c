@@ -0,0 +1,239 @@
+/*
+ * window.c
+ *
+ * Sliding-window statistics. See window.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "window.h"
+
+#define NUM_BUCKETS ((size_t)1 << WINDOW_BUCKET_BITS)
+
+/* Ring capacity when the window is limited by age alone */
+#define INITIAL_CAPACITY 1024
+
+/**
+ * Maps a double to its bucket, so that bucket order is value order
+ */
+static size_t bucket(double x) {
+	uint64_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	/* negative values sort in reverse, positives above all of them */
+	bits = (bits >> 63) ? ~bits : bits | (UINT64_C(1) << 63);
+	return bits >> (64 - WINDOW_BUCKET_BITS);
+}
+
+/**
+ * The value in the middle of a bucket
+ */
+static double bucketValue(size_t b) {
+	uint64_t bits = ((uint64_t)b << (64 - WINDOW_BUCKET_BITS)) | (UINT64_C(1) << (63 - WINDOW_BUCKET_BITS));
+	bits = (bits >> 63) ? bits & ~(UINT64_C(1) << 63) : ~bits;
+
+	double x;
+	memcpy(&x, &bits, sizeof(x));
+	if (isnan(x)) {
+		/* the buckets holding the infinities */
+		return signbit(x) ? -INFINITY : INFINITY;
+	}
+	return x;
+}
+
+static void treeAdd(window_t *w, size_t b, unsigned int delta) {
+	for (size_t i = b + 1; i <= NUM_BUCKETS; i += i & -i) {
+		w->tree[i] += delta;
+	}
+}
+
+/**
+ * Finds the bucket holding the value of 0-based rank k
+ */
+static size_t treeFind(const window_t *w, size_t k) {
+	size_t pos = 0;
+	for (size_t step = NUM_BUCKETS; step > 0; step >>= 1) {
+		if (pos + step <= NUM_BUCKETS && w->tree[pos + step] <= k) {
+			pos += step;
+			k -= w->tree[pos];
+		}
+	}
+	return pos;
+}
+
+/**
+ * Recomputes the mean and M2 from the values in the ring
+ */
+static void recompute(window_t *w) {
+	double mean = 0, m2 = 0;
+	for (size_t i = 0; i < w->count; i++) {
+		double x = w->values[(w->head + i) % w->capacity];
+		double delta = x - mean;
+		mean += delta/(i + 1);
+		m2 += delta*(x - mean);
+	}
+	w->mean = mean;
+	w->m2 = m2;
+	w->removed = 0;
+}
+
+/**
+ * Drops the oldest value
+ */
+static void removeOldest(window_t *w) {
+	double x = w->values[w->head];
+	w->head = (w->head + 1) % w->capacity;
+	w->count--;
+	treeAdd(w, bucket(x), -1u);
+
+	if (w->count == 0) {
+		w->mean = 0;
+		w->m2 = 0;
+		w->removed = 0;
+		return;
+	}
+
+	/* Welford's update run backwards */
+	double delta = x - w->mean;
+	w->mean -= delta/w->count;
+	w->m2 -= delta*(x - w->mean);
+	if (w->m2 < 0) {
+		w->m2 = 0;
+	}
+	if (++w->removed > w->count) {
+		recompute(w);
+	}
+}
+
+/**
+ * Doubles the ring, unwrapping it so the oldest value is first
+ */
+static void growRing(window_t *w) {
+	size_t capacity = w->capacity*2;
+	double *values = malloc(sizeof(double)*capacity);
+	double *times = malloc(sizeof(double)*capacity);
+
+	for (size_t i = 0; i < w->count; i++) {
+		values[i] = w->values[(w->head + i) % w->capacity];
+		times[i] = w->times[(w->head + i) % w->capacity];
+	}
+	free(w->values);
+	free(w->times);
+	w->values = values;
+	w->times = times;
+	w->head = 0;
+	w->capacity = capacity;
+}
+
+/**
+ * Creates an empty window
+ *
+ * @param max_count the most values kept, 0 for no limit
+ * @param max_age the oldest value kept in seconds, 0 for no limit
+ * @return the window
+ */
+window_t *window_new(size_t max_count, double max_age) {
+	window_t *w = malloc(sizeof(window_t));
+	w->capacity = max_count > 0 ? max_count : INITIAL_CAPACITY;
+	w->values = malloc(sizeof(double)*w->capacity);
+	w->times = malloc(sizeof(double)*w->capacity);
+	w->head = 0;
+	w->count = 0;
+	w->max_count = max_count;
+	w->max_age = max_age;
+	w->mean = 0;
+	w->m2 = 0;
+	w->removed = 0;
+	w->tree = calloc(NUM_BUCKETS + 1, sizeof(unsigned int));
+	return w;
+}
+
+/**
+ * Frees a window
+ *
+ * @param w the window
+ */
+void window_free(window_t *w) {
+	free(w->values);
+	free(w->times);
+	free(w->tree);
+	free(w);
+}
+
+/**
+ * Adds a value, dropping the oldest if the window is full
+ *
+ * @param w the window
+ * @param x the value
+ * @param now the current time in seconds
+ */
+void window_add(window_t *w, double x, double now) {
+	if (isnan(x)) {
+		return;
+	}
+	if (w->max_count > 0 && w->count == w->max_count) {
+		removeOldest(w);
+	}
+	if (w->count == w->capacity) {
+		growRing(w);
+	}
+
+	size_t i = (w->head + w->count) % w->capacity;
+	w->values[i] = x;
+	w->times[i] = now;
+	w->count++;
+	treeAdd(w, bucket(x), 1);
+
+	double delta = x - w->mean;
+	w->mean += delta/w->count;
+	w->m2 += delta*(x - w->mean);
+}
+
+/**
+ * Drops values older than the window's age limit
+ *
+ * @param w the window
+ * @param now the current time in seconds
+ */
+void window_expire(window_t *w, double now) {
+	if (w->max_age <= 0) {
+		return;
+	}
+	while (w->count > 0 && w->times[w->head] < now - w->max_age) {
+		removeOldest(w);
+	}
+}
+
+/**
+ * Finds the sample standard deviation of the values in the window
+ *
+ * @param w the window
+ * @return the standard deviation
+ */
+double window_stddev(const window_t *w) {
+	return sqrt(w->m2/(w->count*1.0 - 1.0));
+}
+
+/**
+ * Estimates a quantile, interpolating between the buckets of the two
+ * closest ranks
+ *
+ * @param w the window
+ * @param q the quantile
+ * @return the estimate
+ */
+double window_quantile(const window_t *w, double q) {
+	if (w->count == 0) {
+		return NAN;
+	}
+
+	double rank = q*(w->count - 1);
+	size_t k = (size_t)rank;
+	double lo = bucketValue(treeFind(w, k));
+	if (k + 1 >= w->count) {
+		return lo;
+	}
+	double hi = bucketValue(treeFind(w, k + 1));
+	return lo + (rank - k)*(hi - lo);
+}
@@ -0,0 +1,80 @@
+#ifndef _WINDOW_H_
+#define _WINDOW_H_
+/*
+ * Sliding-window statistics for lab 5.
+ *
+ * A window_t holds the most recent values of a stream, limited by
+ * count, by age, or both. Values live in a ring buffer, oldest first.
+ * The mean and M2 are updated by Welford's rule as values enter and by
+ * its inverse as they leave, and are recomputed from the ring once per
+ * window's worth of removals so rounding error cannot build up.
+ *
+ * Quantiles come from a Fenwick tree of counts over WINDOW_BUCKET_BITS
+ * bit buckets of the double's bit pattern (sign, exponent and the top
+ * mantissa bits), so each bucket spans under 1% of its values. Adding,
+ * removing and finding a rank are all O(log buckets).
+ */
+
+#include <stddef.h>
+
+/* sign + 11 exponent bits + 7 mantissa bits */
+#define WINDOW_BUCKET_BITS 19
+
+typedef struct {
+	double *values;     // ring buffer
+	double *times;      // arrival time of each value
+	size_t head;        // index of the oldest value
+	size_t count;
+	size_t capacity;
+	size_t max_count;   // 0 for no limit
+	double max_age;     // seconds, 0 for no limit
+	double mean;
+	double m2;
+	size_t removed;     // removals since mean and m2 were recomputed
+	unsigned int *tree; // Fenwick tree of bucket counts, 1-based
+} window_t;
+
+/*
+ * creates an empty window
+ * @param max_count the most values kept, 0 for no limit
+ * @param max_age the oldest value kept in seconds, 0 for no limit
+ * @return the window
+ */
+window_t *window_new(size_t max_count, double max_age);
+
+/*
+ * frees a window
+ * @param w the window
+ */
+void window_free(window_t *w);
+
+/*
+ * adds a value, dropping the oldest if the window is full
+ * @param w the window
+ * @param x the value (NaN is ignored)
+ * @param now the current time in seconds
+ */
+void window_add(window_t *w, double x, double now);
+
+/*
+ * drops values older than the window's age limit
+ * @param w the window
+ * @param now the current time in seconds
+ */
+void window_expire(window_t *w, double now);
+
+/*
+ * @param w the window
+ * @return the sample standard deviation of the values in the window
+ */
+double window_stddev(const window_t *w);
+
+/*
+ * estimates a quantile of the values in the window to within a bucket
+ * @param w the window
+ * @param q the quantile, 0 <= q <= 1
+ * @return the estimate, NaN if the window is empty
+ */
+double window_quantile(const window_t *w, double q);
+
+#endif